@@ -0,0 +1,115 @@
+/*
+**  Program   : Test_Archive
+*/
+#define _FW_VERSION "v1.0.0 (19-10-2026)"
+/*
+**  Copyright (c) 2019 .. 2026 Willem Aandewiel
+**
+**  TERMS OF USE: MIT License. See bottom of file.
+***************************************************************************/
+/*
+** Writes lines into a small log with the archive (setArchive()) and a flush
+** policy active, so blocks are archived while newer records are still held
+** in RAM. Every line must be readable afterwards, from the log or from the
+** archive, with and without batching.
+*/
+
+#include "SPIFFS_SysLogger.h"
+#define _FSYS SPIFFS
+
+#define _DEPTH      20
+#define _LINES     100
+
+//-------------------------------------------------------------------------
+//-- returns the number of lines that could not be read back
+int testArchive(uint16_t maxBatch)
+{
+  ESPSL     sysLog;
+  char      lLine[100];
+  int32_t   firstID, lineID;
+  int       gaps = 0;
+
+  sysLog.setOutput(&Serial, 115200);
+  sysLog.setArchive(3, 4000);
+  sysLog.setFlushPolicy(maxBatch, 0);
+  if (!sysLog.begin(_DEPTH, 60, true))
+  {
+    Serial.println("Error creating sysLog!");
+    return -1;
+  }
+  firstID = sysLog.getLastLineID() +1;
+  for(int number=0; number<_LINES; number++)
+  {
+    sysLog.writef("archive test line [%04d]", number);
+  }
+
+  for(lineID = firstID; lineID < (firstID + _LINES); lineID++)
+  {
+    if (   (sysLog.readLine(lineID, lLine, sizeof(lLine)) != ESPSL_READ_OK)
+        || (atoi(strchr(lLine, '[') +1) != (lineID - firstID)) )
+    {
+      Serial.printf("batch [%2d] lineID [%4d] missing or wrong [%s]\r\n", maxBatch, lineID, lLine);
+      gaps++;
+    }
+  }
+  sysLog.status();
+  sysLog.removeSysLog();
+
+  return gaps;
+
+} // testArchive()
+
+
+//-------------------------------------------------------------------------
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println("\nStart Test_Archive ....\n");
+
+#if defined(ESP8266)
+  _FSYS.begin();
+#else
+  _FSYS.begin(true);
+#endif
+
+  for (uint16_t maxBatch : { 1, 8, 16 })
+  {
+    int gaps = testArchive(maxBatch);
+    Serial.printf("setFlushPolicy(%2d, 0): %s (%d lines missing)\r\n", maxBatch
+                                                      , ((gaps == 0) ? "PASS" : "FAIL"), gaps);
+  }
+
+  Serial.println("\nsetup() done .. \n");
+
+} // setup()
+
+
+//-------------------------------------------------------------------------
+void loop()
+{
+  delay(10000);
+
+} // loop()
+
+/***************************************************************************
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to permit
+* persons to whom the Software is furnished to do so, subject to the
+* following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+* OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+* THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+***************************************************************************/
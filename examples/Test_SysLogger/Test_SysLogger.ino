@@ -229,6 +229,7 @@ void setup()
 //-------------------------------------------------------------------------
 void loop() 
 {
+  sysLog.loop();
   sysLog.status();
 
   dumpSysLog();
@@ -0,0 +1,582 @@
+/*
+**  Program   : ESPSL_decode.cpp
+**
+**  Version   : 2.0.1   (20-12-2022)
+**
+**  Copyright (c) 2022 .. 2023 Willem Aandewiel
+**
+**  TERMS OF USE: MIT License. See bottom of file.
+***************************************************************************
+**
+**  Decodes raw sysLog.dat images (pulled off a device) on a PC. The lines
+**  are written in lineID order (the reserved region merged in, continued
+**  lines put together), gaps and corrupt records are reported and every 
+**  boot session gets a summary.
+**  Images are streamed record by record, so memory use does not depend on
+**  the size of the image.
+**
+**  Build (Linux / macOS):
+**    g++ -O2 -std=c++11 -I../../src -o espsl_decode ESPSL_decode.cpp
+**
+**  Usage:
+**    espsl_decode [-j] [-n] [-v] <sysLog.dat> [<sysLog.dat> ..]
+**      -j  JSON lines (same objects as exportJson()), statistics as JSON
+**      -n  no lines, only the statistics
+**      -v  report every corrupt record and every gap (on stderr)
+**
+**  Exit code: 0 all images are fine, 1 one or more images have problems,
+**             2 usage error
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "ESPSL_record.h"
+
+#define _READBUFFER   (64 * 1024)   //-- stdio buffer per image
+#define _MAXRECORD     4096         //-- larger records mean record 0 is corrupt
+#define _MAXREASON       32
+
+struct Options
+{
+  bool  asJson;
+  bool  noLines;
+  bool  verbose;
+};
+
+struct Session
+{
+  bool      active;
+  uint32_t  bootCount;        //-- 0 -> boot line no longer in the log
+  char      reason[_MAXREASON];
+  int32_t   firstID;
+  int32_t   lastID;
+  uint32_t  lines;
+  uint32_t  levels[ESPSL_LEVEL_ERROR +1];
+  uint32_t  events;
+};
+
+struct Image
+{
+  const char       *name;
+  FILE             *file;
+  FILE             *resFile;    //-- second handle, walks the reserved region
+  ESPSL_rec::Meta   meta;
+  uint32_t          recSize;
+  uint32_t          slots;      //-- records (excl. record 0) present in the image
+  char             *rec;        //-- record buffers (recSize +1)
+  char             *resRec;
+  char             *out;        //-- rendered line
+  int               outLen;
+  char             *line;       //-- continued line being put together
+  int               lineLen;
+  int               lineSize;
+  int32_t           lineID;     //-- 0 -> no continued line pending
+  int32_t           lineNext;   //-- lineID of the next continuation record
+  char              lineType;
+  int32_t           lastID;
+  int32_t           ringOldest;
+  uint32_t          resNext;    //-- reserved walk: records visited
+  uint32_t          resStart;   //-- reserved slot with the lowest lineID
+  int32_t           resID;      //-- line under the reserved cursor
+  const char       *resText;
+  char              resType;
+  int32_t           firstID;    //-- first lineID written
+  int32_t           emitted;    //-- last lineID written
+  uint32_t          lines;
+  uint32_t          corrupt;
+  uint32_t          gaps;
+  uint32_t          missing;
+  uint32_t          orphans;    //-- continuation records without their first record
+  int32_t           gapStart;
+  uint32_t          sessions;
+  Session           session;
+};
+
+static Options  opts;
+
+
+//-------------------------------------------------------------------------------------
+//-- problems go to stderr, prefixed with the image name
+static void report(Image *img, const char *fmt, int32_t a, int32_t b)
+{
+  if (!opts.verbose) { return; }
+  fprintf(stderr, "%s: ", img->name);
+  fprintf(stderr, fmt, (long)a, (long)b);
+  fputc('\n', stderr);
+
+} // report()
+
+
+//-------------------------------------------------------------------------------------
+//-- read record slot (sequential unless the caller seeks), false at end of image
+static bool readSlot(Image *img, FILE *file, uint32_t slot, char *rec)
+{
+  if (slot > img->slots) { return false; }
+  if (fread(rec, 1, img->recSize, file) != img->recSize) { return false; }
+  rec[img->recSize] = '\0';
+  return true;
+
+} // readSlot()
+
+static bool seekSlot(Image *img, FILE *file, uint32_t slot)
+{
+  return (fseek(file, (long)slot * img->recSize, SEEK_SET) == 0);
+
+} // seekSlot()
+
+
+//-------------------------------------------------------------------------------------
+//-- check the layout of a record, returns the text (NULL if corrupt), more -> the
+//-- next record continues this one (the text is not trimmed then)
+static const char *checkRecord(Image *img, char *rec, int32_t *lineID, char *recType, bool *more)
+{
+  const char *text;
+  int         end = img->recSize -2;
+
+  if (((rec[end] != '\r') && (rec[end] != _RECMORE)) || (rec[end +1] != '\n')) { return NULL; }
+  for (int p = 0; p < end; p++)
+  {
+    if ((rec[p] < ' ') || (rec[p] > '~')) { return NULL; }
+  }
+  *more    = (rec[end] == _RECMORE);
+  rec[end] = '\0';
+  text = ESPSL_rec::parseKey(rec, lineID, recType);
+  if ((text == NULL) || ((*lineID < 1) && (*lineID != _EMPTYID))) { return NULL; }
+  if (*more) { return text; }
+  //-- trim
+  while ((end > (text - rec)) && (rec[end -1] == ' ')) { rec[--end] = '\0'; }
+  return text;
+
+} // checkRecord()
+
+
+//-------------------------------------------------------------------------------------
+//-- print the summary of the current boot session
+static void closeSession(Image *img)
+{
+  Session *s = &img->session;
+
+  if (!s->active) { return; }
+  s->active = false;
+  if (opts.asJson)
+  {
+    printf("{\"session\":%u,\"boot\":%u,\"reason\":\"%s\",\"first\":%ld,\"last\":%ld,\"lines\":%u"
+           ",\"debug\":%u,\"info\":%u,\"warning\":%u,\"error\":%u,\"events\":%u}\n"
+                 , img->sessions, s->bootCount, s->reason, (long)s->firstID, (long)s->lastID, s->lines
+                 , s->levels[ESPSL_LEVEL_DEBUG], s->levels[ESPSL_LEVEL_INFO]
+                 , s->levels[ESPSL_LEVEL_WARNING], s->levels[ESPSL_LEVEL_ERROR], s->events);
+    return;
+  }
+  if (s->bootCount > 0) printf("# session %u: boot [%u] reset reason [%s]\n", img->sessions, s->bootCount, s->reason);
+  else                  printf("# session %u: boot line no longer in the log\n", img->sessions);
+  printf("#   lines [%ld .. %ld] %u (debug %u, info %u, warning %u, error %u, events %u)\n"
+                 , (long)s->firstID, (long)s->lastID, s->lines
+                 , s->levels[ESPSL_LEVEL_DEBUG], s->levels[ESPSL_LEVEL_INFO]
+                 , s->levels[ESPSL_LEVEL_WARNING], s->levels[ESPSL_LEVEL_ERROR], s->events);
+
+} // closeSession()
+
+
+//-------------------------------------------------------------------------------------
+//-- write one line and count it in its boot session
+static void emitLine(Image *img, int32_t lineID, char recType, const char *text)
+{
+  Session  *s     = &img->session;
+  uint8_t   level = ESPSL_rec::levelOf(recType);
+  uint32_t  bootCount;
+  char      reason[_MAXREASON];
+
+  if ((recType != _RECEVENT) && ESPSL_rec::parseBoot(text, &bootCount, reason, sizeof(reason)))
+  {
+    closeSession(img);
+    s->bootCount = bootCount;
+    strcpy(s->reason, reason);
+  }
+  if (!s->active)
+  {
+    img->sessions++;
+    s->active  = true;
+    s->firstID = lineID;
+    s->lines   = 0;
+    s->events  = 0;
+    memset(s->levels, 0, sizeof(s->levels));
+  }
+  s->lastID = lineID;
+  s->lines++;
+  s->levels[level]++;
+  if (recType == _RECEVENT) { s->events++; }
+  if (img->firstID == 0) { img->firstID = lineID; }
+  img->emitted = lineID;
+  img->lines++;
+
+  if (opts.noLines) { return; }
+  if ((int)((strlen(text) *2) +64) > img->outLen)
+  {
+    img->outLen = (strlen(text) *2) +64;
+    img->out    = (char*)realloc(img->out, img->outLen);
+    if (img->out == NULL) { fprintf(stderr, "%s: out of memory\n", img->name); exit(1); }
+  }
+  if (recType == _RECEVENT)
+  {
+    ESPSL_rec::renderEvent(text, lineID, img->out, img->outLen, opts.asJson);
+    if (opts.asJson) { puts(img->out); }
+    else             { printf("%10ld %-7s %s\n", (long)lineID, "event", img->out); }
+  }
+  else if (opts.asJson)
+  {
+    ESPSL_rec::renderJsonText(text, lineID, level, img->out, img->outLen);
+    puts(img->out);
+  }
+  else
+  {
+    printf("%10ld %-7s %s\n", (long)lineID, ESPSL_rec::levelName(level), text);
+  }
+
+} // emitLine()
+
+
+//-------------------------------------------------------------------------------------
+//-- gaps are reported as a range when the next line is found
+static void endGap(Image *img, int32_t lineID)
+{
+  if (img->gapStart == 0) { return; }
+  img->gaps++;
+  img->missing += (lineID - img->gapStart);
+  report(img, "lines [%ld .. %ld] are missing", img->gapStart, (lineID -1));
+  img->gapStart = 0;
+
+} // endGap()
+
+
+//-------------------------------------------------------------------------------------
+//-- write the continued line put together so far (cut short if its next record is gone)
+static void flushLine(Image *img)
+{
+  if (img->lineID == 0) { return; }
+  while ((img->lineLen > 0) && (img->line[img->lineLen -1] == ' ')) { img->lineLen--; }
+  img->line[img->lineLen] = '\0';
+  emitLine(img, img->lineID, img->lineType, img->line);
+  img->lineID = 0;
+
+} // flushLine()
+
+//-- add the text of a record to the continued line
+static void addToLine(Image *img, const char *text)
+{
+  int len = strlen(text);
+
+  if ((img->lineLen + len +1) > img->lineSize)
+  {
+    img->lineSize = (img->lineLen + len +1) *2;
+    img->line     = (char*)realloc(img->line, img->lineSize);
+    if (img->line == NULL) { fprintf(stderr, "%s: out of memory\n", img->name); exit(1); }
+  }
+  memcpy((img->line + img->lineLen), text, (len +1));
+  img->lineLen += len;
+
+} // addToLine()
+
+//-- a record of the ring: a line, the start of a continued line or a continuation record
+static void addRecord(Image *img, int32_t lineID, char recType, const char *text, bool more)
+{
+  if (recType == _RECCONT)
+  {
+    if ((img->lineID == 0) || (lineID != img->lineNext))
+    {
+      //-- its first record has been overwritten
+      img->orphans++;
+      report(img, "line [%ld] continues line [%ld] that is no longer in the log", lineID, (lineID -1));
+      return;
+    }
+    addToLine(img, text);
+    img->lineNext++;
+    if (!more) { flushLine(img); }
+    return;
+  }
+  flushLine(img);
+  if (!more)
+  {
+    emitLine(img, lineID, recType, text);
+    return;
+  }
+  img->lineID   = lineID;
+  img->lineNext = lineID +1;
+  img->lineType = recType;
+  img->lineLen  = 0;
+  addToLine(img, text);
+
+} // addRecord()
+
+
+//-------------------------------------------------------------------------------------
+//-- move the reserved cursor to the next record (in lineID order)
+static void nextReserved(Image *img)
+{
+  uint32_t  slot;
+  bool      more;
+
+  img->resID = 0;
+  while (img->resNext < (uint32_t)img->meta.numReserved)
+  {
+    slot = img->meta.numLines +1 + ((img->resStart + img->resNext) % img->meta.numReserved);
+    img->resNext++;
+    if (!seekSlot(img, img->resFile, slot) || !readSlot(img, img->resFile, slot, img->resRec)) { return; }
+    img->resText = checkRecord(img, img->resRec, &img->resID, &img->resType, &more);
+    if ((img->resText != NULL) && (img->resID > img->emitted)) { return; }
+    img->resID = 0;
+  }
+
+} // nextReserved()
+
+//-- write the reserved lines older than lineID
+static void emitReserved(Image *img, int32_t lineID)
+{
+  while ((img->resID > 0) && (img->resID < lineID))
+  {
+    flushLine(img);
+    emitLine(img, img->resID, img->resType, img->resText);
+    nextReserved(img);
+  }
+
+} // emitReserved()
+
+
+//-------------------------------------------------------------------------------------
+//-- pass 1: check every record, find the newest lineID and the start of the reserved ring
+static void scanImage(Image *img)
+{
+  int32_t     lineID, resLowest = 0;
+  char        recType;
+  bool        more;
+  const char *text;
+
+  seekSlot(img, img->file, 1);
+  for (uint32_t slot = 1; readSlot(img, img->file, slot, img->rec); slot++)
+  {
+    text = checkRecord(img, img->rec, &lineID, &recType, &more);
+    if (text == NULL)
+    {
+      img->corrupt++;
+      report(img, "record [%ld] is corrupt (offset %ld)", slot, (int32_t)(slot * img->recSize));
+      continue;
+    }
+    if (lineID == _EMPTYID) { continue; }
+    if ((slot <= (uint32_t)img->meta.numLines) && (ESPSL_rec::ringSlot(lineID, img->meta.numLines) != slot))
+    {
+      img->corrupt++;
+      report(img, "record [%ld] holds line [%ld] of another record", slot, lineID);
+      continue;
+    }
+    if (lineID > img->lastID) { img->lastID = lineID; }
+    if ((slot > (uint32_t)img->meta.numLines) && ((resLowest == 0) || (lineID < resLowest)))
+    {
+      resLowest     = lineID;
+      img->resStart = slot - img->meta.numLines -1;
+    }
+  }
+  img->ringOldest = (img->lastID < img->meta.numLines) ? 1 : (img->lastID - img->meta.numLines +1);
+
+} // scanImage()
+
+
+//-------------------------------------------------------------------------------------
+//-- pass 2: write the lines in lineID order, the ring is read from the oldest record on
+//-- (with one wrap), the reserved region is merged in (a line that is still in the ring
+//-- is taken from the ring, the reserved copy of a continued line has its first part only)
+static void decodeImage(Image *img)
+{
+  int32_t     lineID, recID;
+  uint32_t    slot, nextSlot = 0;
+  char        recType;
+  bool        more;
+  const char *text;
+
+  nextReserved(img);
+  for (lineID = img->ringOldest; (lineID > 0) && (lineID <= img->lastID); lineID++)
+  {
+    emitReserved(img, lineID);
+    slot = ESPSL_rec::ringSlot(lineID, img->meta.numLines);
+    if ((slot != nextSlot) && !seekSlot(img, img->file, slot)) { break; }
+    nextSlot = slot +1;
+    if (   !readSlot(img, img->file, slot, img->rec)
+        || ((text = checkRecord(img, img->rec, &recID, &recType, &more)) == NULL)
+        || (recID != lineID) )
+    {
+      flushLine(img);
+      if (img->resID == lineID)
+      {
+        endGap(img, lineID);
+        emitLine(img, img->resID, img->resType, img->resText);
+        nextReserved(img);
+      }
+      else if (img->gapStart == 0) { img->gapStart = lineID; }
+      continue;
+    }
+    if (img->resID == lineID) { nextReserved(img); }
+    endGap(img, lineID);
+    addRecord(img, lineID, recType, text, more);
+  }
+  flushLine(img);
+  endGap(img, lineID);
+  closeSession(img);
+
+} // decodeImage()
+
+
+//-------------------------------------------------------------------------------------
+//-- decode one image, false if it has problems
+static bool processImage(const char *name)
+{
+  Image   img;
+  char    meta[_MAXRECORD];
+  long    fileSize;
+  bool    isOk;
+
+  memset(&img, 0, sizeof(img));
+  img.name = name;
+  img.file = fopen(name, "rb");
+  if (img.file == NULL)
+  {
+    fprintf(stderr, "%s: cannot open\n", name);
+    return false;
+  }
+  setvbuf(img.file, NULL, _IOFBF, _READBUFFER);
+  fseek(img.file, 0, SEEK_END);
+  fileSize = ftell(img.file);
+  fseek(img.file, 0, SEEK_SET);
+
+  if (   (fgets(meta, sizeof(meta), img.file) == NULL)
+      || !ESPSL_rec::parseMeta(meta, &img.meta)
+      || (ESPSL_rec::recSize(img.meta.lineWidth) > _MAXRECORD)
+      || (ESPSL_rec::recSize(img.meta.lineWidth) != strlen(meta)) )
+  {
+    fprintf(stderr, "%s: no valid META DATA record, not a sysLog image\n", name);
+    fclose(img.file);
+    return false;
+  }
+  img.recSize = ESPSL_rec::recSize(img.meta.lineWidth);
+  img.slots   = (fileSize / img.recSize) -1;
+  if (img.slots > (uint32_t)(img.meta.numLines + img.meta.numReserved))
+  {
+    img.slots = img.meta.numLines + img.meta.numReserved;
+  }
+  img.rec     = (char*)malloc(img.recSize +1);
+  img.resRec  = (char*)malloc(img.recSize +1);
+  img.outLen  = (img.recSize *2) +64;
+  img.out     = (char*)malloc(img.outLen);
+  img.resFile = fopen(name, "rb");
+  if ((img.rec == NULL) || (img.resRec == NULL) || (img.out == NULL) || (img.resFile == NULL))
+  {
+    fprintf(stderr, "%s: out of resources\n", name);
+    exit(1);
+  }
+
+  if (opts.asJson)
+  {
+    printf("{\"image\":\"%s\",\"numLines\":%ld,\"lineWidth\":%ld,\"reserved\":%ld}\n"
+                 , name, (long)img.meta.numLines, (long)img.meta.lineWidth, (long)img.meta.numReserved);
+  }
+  else
+  {
+    printf("# %s: %ld lines of %ld chars, %ld reserved\n"
+                 , name, (long)img.meta.numLines, (long)img.meta.lineWidth, (long)img.meta.numReserved);
+  }
+  if (fileSize != (long)((img.meta.numLines + img.meta.numReserved +1) * img.recSize))
+  {
+    img.corrupt++;
+    report(&img, "size [%ld] does not match the META DATA [%ld]", fileSize
+                             , (img.meta.numLines + img.meta.numReserved +1) * img.recSize);
+  }
+
+  scanImage(&img);
+  decodeImage(&img);
+
+  isOk = ((img.corrupt == 0) && (img.gaps == 0));
+  if (opts.asJson)
+  {
+    printf("{\"image\":\"%s\",\"lines\":%u,\"first\":%ld,\"last\":%ld,\"sessions\":%u"
+           ",\"gaps\":%u,\"missing\":%u,\"corrupt\":%u,\"orphans\":%u}\n"
+                 , name, img.lines, (long)img.firstID, (long)img.lastID, img.sessions
+                 , img.gaps, img.missing, img.corrupt, img.orphans);
+  }
+  else
+  {
+    printf("# %s: %u lines, last [%ld], %u sessions, %u gaps (%u lines missing), %u corrupt records\n"
+                 , name, img.lines, (long)img.lastID, img.sessions, img.gaps, img.missing, img.corrupt);
+    if (img.orphans > 0) printf("# %s: %u continuation records without their first record\n", name, img.orphans);
+  }
+
+  free(img.rec);
+  free(img.resRec);
+  free(img.out);
+  free(img.line);
+  fclose(img.resFile);
+  fclose(img.file);
+  return isOk;
+
+} // processImage()
+
+
+//-------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  int   arg, images = 0, failed = 0;
+
+  for (arg = 1; (arg < argc) && (argv[arg][0] == '-') && (argv[arg][1] != '\0'); arg++)
+  {
+    for (const char *o = argv[arg] +1; *o; o++)
+    {
+      switch(*o)
+      {
+        case 'j': opts.asJson  = true; break;
+        case 'n': opts.noLines = true; break;
+        case 'v': opts.verbose = true; break;
+        default:  fprintf(stderr, "usage: %s [-j] [-n] [-v] <sysLog.dat> ..\n", argv[0]);
+                  return 2;
+      }
+    }
+  }
+  if (arg >= argc)
+  {
+    fprintf(stderr, "usage: %s [-j] [-n] [-v] <sysLog.dat> ..\n", argv[0]);
+    return 2;
+  }
+
+  for (; arg < argc; arg++)
+  {
+    images++;
+    if (!processImage(argv[arg])) { failed++; }
+  }
+  if (images > 1)
+  {
+    if (opts.asJson) printf("{\"images\":%d,\"failed\":%d}\n", images, failed);
+    else             printf("# %d images, %d with problems\n", images, failed);
+  }
+  return (failed > 0) ? 1 : 0;
+
+} // main()
+
+/***************************************************************************
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to permit
+* persons to whom the Software is furnished to do so, subject to the
+* following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+* OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+* THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+***************************************************************************/
@@ -0,0 +1,300 @@
+/*
+**  Program   : ESPSL_format.h
+**
+**  Version   : 2.0.1   (20-12-2022)
+**
+**  Copyright (c) 2022 .. 2023 Willem Aandewiel
+**
+**  TERMS OF USE: MIT License. See bottom of file.
+***************************************************************************
+**
+**  Compile time checked formatting for SPIFFS_SysLogger (SYSLOG_F() and
+**  SYSLOG_DBG()). The format string is checked against the types of the
+**  arguments by the compiler, at run time every argument is formatted by
+**  a routine for its own type (no va_list, no vsnprintf() for plain
+**  %d, %i, %u, %x, %X, %c and %s).
+**
+**  Supported: %d %i %u %x %X %o %c %s %p %f %F %e %E %g %G and %%, with
+**  flags, width, precision and length modifiers. A '*' width or precision
+**  is not supported (use writef() for that).
+***************************************************************************/
+
+#ifndef _ESPSL_FORMAT_H
+#define _ESPSL_FORMAT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+namespace ESPSL_fmt {
+
+  template<typename... A> struct Types {};
+
+  //-- only used in decltype(), never called
+  template<typename... A> Types<typename std::decay<A>::type...> typesOf(A&&...);
+
+  //-----------------------------------------------------------------------------------
+  //-- compile time part (C++11 constexpr: one return statement per function)
+  //-----------------------------------------------------------------------------------
+  constexpr bool isFlag(char c)   { return (c=='-') || (c=='+') || (c==' ') || (c=='#') || (c=='0'); }
+  constexpr bool isDigit(char c)  { return (c>='0') && (c<='9'); }
+  constexpr bool isLength(char c) { return (c=='h') || (c=='l') || (c=='L') || (c=='z') || (c=='j') || (c=='t'); }
+
+  //-- position of the next '%' that starts a conversion, -1 if there is none
+  constexpr int findSpec(const char *f, int p)
+  {
+    return (f[p] == '\0') ? -1
+         : (f[p] != '%')  ? findSpec(f, p+1)
+         : (f[p+1] == '%') ? findSpec(f, p+2)
+         : p;
+  }
+  constexpr int skipFlags(const char *f, int p)   { return isFlag(f[p])   ? skipFlags(f, p+1)  : p; }
+  constexpr int skipDigits(const char *f, int p)  { return isDigit(f[p])  ? skipDigits(f, p+1) : p; }
+  constexpr int skipLength(const char *f, int p)  { return isLength(f[p]) ? skipLength(f, p+1) : p; }
+  constexpr int skipPrecision(const char *f, int p)
+  {
+    return (f[p] == '.') ? skipDigits(f, p+1) : p;
+  }
+  //-- position of the conversion char of the spec starting @p ('%')
+  constexpr int convPos(const char *f, int p)
+  {
+    return skipLength(f, skipPrecision(f, skipDigits(f, skipFlags(f, p+1))));
+  }
+
+  template<typename T> constexpr bool isInt()
+  {
+    return std::is_integral<T>::value || std::is_enum<T>::value;
+  }
+  template<typename T> constexpr bool isString()
+  {
+    return std::is_same<T, const char*>::value || std::is_same<T, char*>::value;
+  }
+
+  //-- does conversion c accept an argument of type T?
+  template<typename T> constexpr bool accepts(char c)
+  {
+    return ((c=='d') || (c=='i') || (c=='u') || (c=='x') || (c=='X') || (c=='o') || (c=='c')) ? isInt<T>()
+         : ((c=='f') || (c=='F') || (c=='e') || (c=='E') || (c=='g') || (c=='G'))             ? std::is_floating_point<T>::value
+         : (c=='s') ? isString<T>()
+         : (c=='p') ? std::is_pointer<T>::value
+         : false;
+  }
+
+  template<typename... A> struct Checker;
+
+  template<> struct Checker<>
+  {
+    static constexpr bool check(const char *f, int p) { return findSpec(f, p) < 0; }
+  };
+
+  template<typename A, typename... R> struct Checker<A, R...>
+  {
+    static constexpr bool check(const char *f, int p)
+    {
+      return (findSpec(f, p) < 0) ? false     //-- more arguments than conversions
+           : convert(f, convPos(f, findSpec(f, p)));
+    }
+    static constexpr bool convert(const char *f, int c)
+    {
+      return accepts<A>(f[c]) && Checker<R...>::check(f, c+1);
+    }
+  };
+
+  template<typename... A> constexpr bool validate(const char *fmt, Types<A...>)
+  {
+    return Checker<A...>::check(fmt, 0);
+  }
+
+  //-----------------------------------------------------------------------------------
+  //-- run time part
+  //-----------------------------------------------------------------------------------
+  struct Out
+  {
+    char  *buf;
+    int    len;
+    int    size;
+    void   put(char c)  { if (len < (size -1)) { buf[len++] = c; buf[len] = '\0'; } }
+    void   put(const char *s, int n) { while ((n-- > 0) && *s) { put(*s++); } }
+  };
+
+  //-- copy literal text up to the next spec, returns a pointer to its '%'
+  inline const char *copyLiteral(Out &out, const char *f)
+  {
+    while (*f)
+    {
+      if (*f == '%')
+      {
+        if (*(f+1) != '%') { break; }
+        f++;
+      }
+      out.put(*f++);
+    }
+    return f;
+  }
+
+  //-- a plain spec ("%d", "%ld", "%s" ..) can use the fast path
+  inline bool isPlain(const char *spec, const char *conv)
+  {
+    return skipLength(spec, 1) == (conv - spec);
+  }
+
+  //-- spec without length modifiers, with 'll'/'L' (or nothing) in their place
+  inline void buildSpec(char *specOut, int size, const char *spec, const char *conv, const char *length)
+  {
+    int n = 0;
+    for (const char *p = spec; (p < conv) && (n < (size -4)); p++)
+    {
+      if (!isLength(*p)) { specOut[n++] = *p; }
+    }
+    while (*length && (n < (size -2))) { specOut[n++] = *length++; }
+    specOut[n++] = *conv;
+    specOut[n]   = '\0';
+  }
+
+  inline void putUnsigned(Out &out, unsigned long long v, unsigned base, bool upper)
+  {
+    char  digits[24];
+    int   n = 0;
+    do {
+      unsigned d = (unsigned)(v % base);
+      digits[n++] = (d < 10) ? ('0' + d) : ((upper ? 'A' : 'a') + d - 10);
+      v /= base;
+    } while (v > 0);
+    while (n > 0) { out.put(digits[--n]); }
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+  putArg(Out &out, const char *spec, const char *conv, T v)
+  {
+    char  specBuff[16];
+    char  numBuff[32];
+    bool  isSigned = std::is_signed<T>::value && (*conv == 'd' || *conv == 'i');
+
+    if (isPlain(spec, conv))
+    {
+      switch(*conv)
+      {
+        case 'c': out.put((char)v); return;
+        case 'x': putUnsigned(out, (unsigned long long)v & (~0ULL >> (64 - (8 * sizeof(T)))), 16, false); return;
+        case 'X': putUnsigned(out, (unsigned long long)v & (~0ULL >> (64 - (8 * sizeof(T)))), 16, true);  return;
+        case 'o': break;
+        default:  if (isSigned && ((long long)v < 0))
+                  {
+                    out.put('-');
+                    putUnsigned(out, (unsigned long long)(-(long long)v), 10, false);
+                  }
+                  else if (isSigned)  putUnsigned(out, (unsigned long long)v, 10, false);
+                  else                putUnsigned(out, (unsigned long long)v & (~0ULL >> (64 - (8 * sizeof(T)))), 10, false);
+                  return;
+      }
+    }
+    if (*conv == 'c')
+    {
+      buildSpec(specBuff, sizeof(specBuff), spec, conv, "");
+      snprintf(numBuff, sizeof(numBuff), specBuff, (int)v);
+    }
+    else if (isSigned)
+    {
+      buildSpec(specBuff, sizeof(specBuff), spec, conv, "ll");
+      snprintf(numBuff, sizeof(numBuff), specBuff, (long long)v);
+    }
+    else
+    {
+      buildSpec(specBuff, sizeof(specBuff), spec, conv, "ll");
+      snprintf(numBuff, sizeof(numBuff), specBuff
+                      , (unsigned long long)v & (~0ULL >> (64 - (8 * sizeof(T)))));
+    }
+    out.put(numBuff, sizeof(numBuff));
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_floating_point<T>::value>::type
+  putArg(Out &out, const char *spec, const char *conv, T v)
+  {
+    char  specBuff[16];
+    char  numBuff[48];
+
+    buildSpec(specBuff, sizeof(specBuff), spec, conv, "");
+    snprintf(numBuff, sizeof(numBuff), specBuff, (double)v);
+    out.put(numBuff, sizeof(numBuff));
+  }
+
+  inline void putArg(Out &out, const char *spec, const char *conv, const char *v)
+  {
+    char  specBuff[16];
+
+    if (v == NULL) { v = "(null)"; }
+    if (isPlain(spec, conv))
+    {
+      out.put(v, (out.size - out.len));
+      return;
+    }
+    buildSpec(specBuff, sizeof(specBuff), spec, conv, "");
+    int n = snprintf(out.buf + out.len, (out.size - out.len), specBuff, v);
+    out.len += (n < (out.size - out.len)) ? n : (out.size - out.len -1);
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_pointer<T>::value && !std::is_convertible<T, const char*>::value>::type
+  putArg(Out &out, const char *spec, const char *conv, T v)
+  {
+    char  numBuff[24];
+
+    snprintf(numBuff, sizeof(numBuff), "%p", (const void*)v);
+    out.put(numBuff, sizeof(numBuff));
+  }
+
+  inline void format(Out &out, const char *f)
+  {
+    copyLiteral(out, f);
+  }
+
+  template<typename A, typename... R> void format(Out &out, const char *f, A a, R... r)
+  {
+    f = copyLiteral(out, f);
+    if (*f == '\0') { return; }
+    const char *conv = f + convPos(f, 0);
+    putArg(out, f, conv, a);
+    format(out, conv +1, r...);
+  }
+
+} // namespace ESPSL_fmt
+
+//-- writef() / writeDbg() with a format string that is checked by the compiler
+//-- (fmt must be a string literal)
+#define SYSLOG_F(sysLog, fmt, ...)                                                        \
+    ({ static_assert(ESPSL_fmt::validate(fmt, decltype(ESPSL_fmt::typesOf(__VA_ARGS__))()) \
+                    , "SYSLOG_F(): format does not match the arguments");                 \
+       (sysLog).writeT(NULL, fmt, ##__VA_ARGS__); })
+
+#define SYSLOG_DBG(sysLog, dbg, fmt, ...)                                                 \
+    ({ static_assert(ESPSL_fmt::validate(fmt, decltype(ESPSL_fmt::typesOf(__VA_ARGS__))()) \
+                    , "SYSLOG_DBG(): format does not match the arguments");               \
+       (sysLog).writeT(dbg, fmt, ##__VA_ARGS__); })
+
+#endif
+
+/***************************************************************************
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to permit
+* persons to whom the Software is furnished to do so, subject to the
+* following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+* OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+* THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+***************************************************************************/
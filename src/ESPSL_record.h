@@ -0,0 +1,350 @@
+/*
+**  Program   : ESPSL_record.h
+**
+**  Version   : 2.0.1   (20-12-2022)
+**
+**  Copyright (c) 2022 .. 2023 Willem Aandewiel
+**
+**  TERMS OF USE: MIT License. See bottom of file.
+***************************************************************************
+**
+**  Layout of the records in the system log file and the routines to parse
+**  and render them. No Arduino dependencies, so the same code is used by
+**  the library and by the host tool in extras/ESPSL_decode.
+**
+**  Every record is "%010d" (lineID) + separator + text, padded with spaces
+**  to (lineWidth + _KEYLEN -1) chars and closed with "\r\n". Record 0 holds
+**  the geometry of the file:
+**    "0000000000|<generation>;<numLines>;<lineWidth>;<numReserved>;<version>; META DATA .."
+**  (files written before version 2 have no version, the oldest no numReserved)
+**  generation is "%08d", a random number that changes every time the file is
+**  created (older files have 00000000).
+**  Record 1 .. numLines is the ring (lineID n lives in record (n % numLines) +1),
+**  followed by numReserved records for warnings and errors (see setRetention()).
+**
+**  A line that does not fit in one record continues in the next record(s)
+**  (next lineID, separator _RECCONT). A record that is continued ends with
+**  _RECMORE in stead of '\r'.
+***************************************************************************/
+
+#ifndef _ESPSL_RECORD_H
+#define _ESPSL_RECORD_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define _KEYLEN        11
+#define _EMPTYID       -1
+#define _RECTEXT      '|'      //-- record separators: free text (info)
+#define _RECEVENT     '#'      //--                    structured event (ESPSL_Event)
+#define _RECDEBUG     ':'      //--                    free text, debug
+#define _RECWARNING   '!'      //--                    free text, warning
+#define _RECERROR     '*'      //--                    free text, error
+#define _RECCONT      '+'      //--                    rest of the line before
+#define _RECMORE      '+'      //-- replaces the '\r' of a record that is continued
+#define _BOOTLINE     "=== boot [%u] reset reason [%s] ==="
+#define _METAMAGIC    " META DATA"
+#define _METAVERSION    2      //-- files with a higher version are not understood
+
+//-- severity of a line (see writeLevel())
+#define ESPSL_LEVEL_DEBUG    0
+#define ESPSL_LEVEL_INFO     1   //-- write(), writef() ..
+#define ESPSL_LEVEL_WARNING  2   //-- warnings and errors are also kept in the
+#define ESPSL_LEVEL_ERROR    3   //-- reserved region (see setRetention())
+
+namespace ESPSL_rec {
+
+  static const char b64Digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz+/";
+
+  struct Meta
+  {
+    int32_t   generation;
+    int32_t   numLines;
+    int32_t   lineWidth;
+    int32_t   numReserved;
+    int32_t   version;
+  };
+
+  //-- record separator of a severity level (and back)
+  inline char recTypeOf(uint8_t level)
+  {
+    switch(level)
+    {
+      case ESPSL_LEVEL_DEBUG:   return _RECDEBUG;
+      case ESPSL_LEVEL_WARNING: return _RECWARNING;
+      case ESPSL_LEVEL_ERROR:   return _RECERROR;
+      default:                  return _RECTEXT;
+    }
+  } // recTypeOf()
+
+  inline uint8_t levelOf(char recType)
+  {
+    switch(recType)
+    {
+      case _RECDEBUG:   return ESPSL_LEVEL_DEBUG;
+      case _RECWARNING: return ESPSL_LEVEL_WARNING;
+      case _RECERROR:   return ESPSL_LEVEL_ERROR;
+      default:          return ESPSL_LEVEL_INFO;
+    }
+  } // levelOf()
+
+  inline const char *levelName(uint8_t level)
+  {
+    static const char *names[] = { "debug", "info", "warning", "error" };
+    return (level <= ESPSL_LEVEL_ERROR) ? names[level] : "info";
+
+  } // levelName()
+
+  inline bool isRecType(char c)
+  {
+    return (c == _RECTEXT) || (c == _RECEVENT) || (c == _RECDEBUG)
+        || (c == _RECWARNING) || (c == _RECERROR) || (c == _RECCONT);
+  } // isRecType()
+
+  //-- bytes of a record on file (incl. "\r\n")
+  inline uint32_t recSize(int32_t lineWidth) { return (lineWidth + _KEYLEN +1); }
+
+  //-- record of the ring that holds lineID
+  inline uint32_t ringSlot(int32_t lineID, int32_t numLines) { return ((lineID % numLines) +1); }
+
+  //-- decimal number, advances *pChar, false if there are no digits
+  inline bool parseNumber(const char **pChar, int32_t *value)
+  {
+    const char *start    = *pChar;
+    bool        negative = (**pChar == '-');
+    int32_t     number   = 0;
+
+    if (negative) { (*pChar)++; }
+    while ((**pChar >= '0') && (**pChar <= '9'))
+    {
+      number = (number * 10) + (**pChar - '0');
+      (*pChar)++;
+    }
+    *value = (negative ? -number : number);
+    return (*pChar > (start + (negative ? 1 : 0)));
+
+  } // parseNumber()
+
+  //-- "%010d" + separator, returns the text after the separator (NULL if this is no key)
+  inline const char *parseKey(const char *rec, int32_t *lineID, char *recType)
+  {
+    const char *pChar = rec;
+
+    *recType = '\0';
+    if (!parseNumber(&pChar, lineID) || ((pChar - rec) != (_KEYLEN -1))) { return NULL; }
+    *recType = *pChar;
+    if (!isRecType(*pChar)) { return NULL; }
+    return (pChar +1);
+
+  } // parseKey()
+
+  //-- geometry from record 0 (without sscanf()), false if record 0 is no META DATA
+  //-- record or it was written by a newer version
+  inline bool parseMeta(const char *rec, Meta *meta)
+  {
+    const char *pChar = rec;
+    int32_t     value;
+    char        recType;
+
+    meta->generation  = 0;
+    meta->numLines    = 0;
+    meta->lineWidth   = 0;
+    meta->numReserved = 0;
+    meta->version     = 1;
+    pChar = parseKey(rec, &value, &recType);
+    if ((pChar == NULL) || (value != 0))    { return false; }
+    if (!parseNumber(&pChar, &meta->generation) || (*pChar++ != ';'))   { return false; }
+    if (!parseNumber(&pChar, &meta->numLines) || (*pChar++ != ';'))     { return false; }
+    if (!parseNumber(&pChar, &meta->lineWidth) || (*pChar++ != ';'))    { return false; }
+    if (parseNumber(&pChar, &value) && (*pChar++ == ';'))
+    {
+      meta->numReserved = (value > 0) ? value : 0;
+      if (parseNumber(&pChar, &value) && (*pChar++ == ';')) { meta->version = value; }
+    }
+    if (strncmp(pChar, _METAMAGIC, strlen(_METAMAGIC)) != 0)            { return false; }
+    return (meta->numLines > 0) && (meta->lineWidth > 0) && (meta->version <= _METAVERSION);
+
+  } // parseMeta()
+
+  //-- "=== boot [n] reset reason [..] ===", false if text is no boot line
+  inline bool parseBoot(const char *text, uint32_t *bootCount, char *reason, int reasonLen)
+  {
+    const char *pChar = text;
+    const char *end;
+    int32_t     value;
+
+    if (strncmp(pChar, "=== boot [", 10) != 0) { return false; }
+    pChar += 10;
+    if (!parseNumber(&pChar, &value) || (strncmp(pChar, "] reset reason [", 16) != 0)) { return false; }
+    pChar += 16;
+    end    = strstr(pChar, "] ===");
+    if (end == NULL) { return false; }
+    *bootCount = (uint32_t)value;
+    if (reasonLen > 0)
+    {
+      int len = ((end - pChar) < (reasonLen -1)) ? (end - pChar) : (reasonLen -1);
+      memcpy(reason, pChar, len);
+      reason[len] = '\0';
+    }
+    return true;
+
+  } // parseBoot()
+
+  //-- base64 digits up to the next '`'
+  inline uint32_t decodeNumber(const char **pChar)
+  {
+    uint32_t    value = 0;
+    const char *digit;
+
+    while ((**pChar != '\0') && (**pChar != '`'))
+    {
+      digit = strchr(b64Digits, **pChar);
+      if (digit != NULL) { value = (value << 6) | (uint32_t)(digit - b64Digits); }
+      (*pChar)++;
+    }
+    return value;
+
+  } // decodeNumber()
+
+  //-- append to out, JSON-escaped if asked for
+  inline void appendOut(char *out, int outLen, int *outPos, const char *text, int textLen, bool escape)
+  {
+    for (int i=0; (i < textLen) && (*outPos < (outLen -2)); i++)
+    {
+      if (escape && ((text[i] == '"') || (text[i] == '\\'))) { out[(*outPos)++] = '\\'; }
+      out[(*outPos)++] = text[i];
+    }
+    out[*outPos] = '\0';
+
+  } // appendOut()
+
+  //-----------------------------------------------------------------------------------
+  //-- render a structured record ("#" separator) as "event key=value .." or as a
+  //-- JSON object
+  //--   <event>`<type><key>:<value>`<type><key>:<value>` ..
+  //--   type 'i' int (zigzag, base64 digits), 'u' unsigned int (base64 digits)
+  //--        'f' float (IEEE754, 6 base64 digits)
+  //--        's' string ('`' and '\\' escaped with '\\'), 'b' bool ('0' or '1')
+  //-----------------------------------------------------------------------------------
+  inline void renderEvent(const char *rec, int32_t lineID, char *out, int outLen, bool asJson)
+  {
+    const char *pChar = rec;
+    const char *start;
+    char        numBuff[32];
+    char        type;
+    int         outPos = 0;
+    uint32_t    bits;
+
+    out[0] = '\0';
+    //-- event name
+    start = pChar;
+    while ((*pChar != '\0') && (*pChar != '`')) { pChar++; }
+    if (asJson)
+    {
+      snprintf(numBuff, sizeof(numBuff), "{\"id\":%ld,\"event\":\"", (long)lineID);
+      appendOut(out, outLen, &outPos, numBuff, strlen(numBuff), false);
+    }
+    appendOut(out, outLen, &outPos, start, (pChar - start), asJson);
+    if (asJson) { appendOut(out, outLen, &outPos, "\"", 1, false); }
+
+    while (*pChar == '`')
+    {
+      pChar++;
+      type = *pChar;
+      if ((type == '\0') || (*(pChar+1) == '\0')) { break; }
+      pChar++;
+      //-- key
+      start = pChar;
+      while ((*pChar != '\0') && (*pChar != ':')) { pChar++; }
+      appendOut(out, outLen, &outPos, (asJson ? ",\"" : " "), (asJson ? 2 : 1), false);
+      appendOut(out, outLen, &outPos, start, (pChar - start), asJson);
+      appendOut(out, outLen, &outPos, (asJson ? "\":" : "="), (asJson ? 2 : 1), false);
+      if (*pChar == ':') { pChar++; }
+      //-- value
+      switch(type)
+      {
+        case 'i': bits = decodeNumber(&pChar);
+                  snprintf(numBuff, sizeof(numBuff), "%ld", (long)(int32_t)((bits >> 1) ^ (0 - (bits & 1))));
+                  appendOut(out, outLen, &outPos, numBuff, strlen(numBuff), false);
+                  break;
+        case 'u': bits = decodeNumber(&pChar);
+                  snprintf(numBuff, sizeof(numBuff), "%lu", (unsigned long)bits);
+                  appendOut(out, outLen, &outPos, numBuff, strlen(numBuff), false);
+                  break;
+        case 'f': { float fValue;
+                    bits = decodeNumber(&pChar);
+                    memcpy(&fValue, &bits, sizeof(fValue));
+                    //-- JSON has no nan or inf
+                    if (asJson && !isfinite(fValue)) { strcpy(numBuff, "null"); }
+                    else { snprintf(numBuff, sizeof(numBuff), "%g", fValue); }
+                    appendOut(out, outLen, &outPos, numBuff, strlen(numBuff), false);
+                  }
+                  break;
+        case 'b': appendOut(out, outLen, &outPos, ((*pChar == '1') ? "true" : "false")
+                                                , ((*pChar == '1') ? 4 : 5), false);
+                  while ((*pChar != '\0') && (*pChar != '`')) { pChar++; }
+                  break;
+        default:  //-- 's'
+                  if (asJson) { appendOut(out, outLen, &outPos, "\"", 1, false); }
+                  while ((*pChar != '\0') && (*pChar != '`'))
+                  {
+                    if ((*pChar == '\\') && (*(pChar+1) != '\0')) { pChar++; }
+                    appendOut(out, outLen, &outPos, pChar, 1, asJson);
+                    pChar++;
+                  }
+                  if (asJson) { appendOut(out, outLen, &outPos, "\"", 1, false); }
+      }
+    }
+    if (asJson) { appendOut(out, outLen, &outPos, "}", 1, false); }
+
+  } // renderEvent()
+
+  //-----------------------------------------------------------------------------------
+  //-- render a free text record as a JSON object
+  inline void renderJsonText(const char *rec, int32_t lineID, uint8_t level, char *out, int outLen)
+  {
+    int   outPos = 0;
+    char  numBuff[24];
+
+    snprintf(numBuff, sizeof(numBuff), "{\"id\":%ld,", (long)lineID);
+    appendOut(out, outLen, &outPos, numBuff, strlen(numBuff), false);
+    if (level != ESPSL_LEVEL_INFO)
+    {
+      appendOut(out, outLen, &outPos, "\"level\":\"", 9, false);
+      appendOut(out, outLen, &outPos, levelName(level), strlen(levelName(level)), false);
+      appendOut(out, outLen, &outPos, "\",", 2, false);
+    }
+    appendOut(out, outLen, &outPos, "\"msg\":\"", 7, false);
+    appendOut(out, outLen, &outPos, rec, strlen(rec), true);
+    appendOut(out, outLen, &outPos, "\"}", 2, false);
+
+  } // renderJsonText()
+
+} // namespace ESPSL_rec
+
+#endif
+
+/***************************************************************************
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to permit
+* persons to whom the Software is furnished to do so, subject to the
+* following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+* OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+* OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+* THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+***************************************************************************/
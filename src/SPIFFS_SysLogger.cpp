@@ -10,6 +10,24 @@
 */
 
 #include "SPIFFS_SysLogger.h"
+#include <time.h>
+
+static const char _SPACES[] = "                                ";
+
+static void indexText(uint8_t *bloom, const char *text, char recType);
+
+#if defined(ESP32)
+//-- records held by setSleepPolicy() survive a deep sleep (and a crash) in RTC memory
+struct ESPSL_rtcBatch {
+  uint32_t  magic;
+  int32_t   firstID;
+  uint16_t  recLength;
+  uint16_t  count;
+  uint32_t  check;
+  char      records[_RTCBATCHBYTES];
+};
+RTC_NOINIT_ATTR static ESPSL_rtcBatch _rtcBatch;
+#endif
 
 //-- Constructor
 ESPSL::ESPSL() 
@@ -18,23 +36,50 @@ ESPSL::ESPSL()
   _serialOn = false;
   _Stream   = NULL;
   _streamOn = false;
+#if defined(ESP32)
+  _fileLock = xSemaphoreCreateRecursiveMutex();
+#endif
+}
+
+//-------------------------------------------------------------------------------------
+//-- Destructor: write what is held in RAM, give back the buffers and the files
+ESPSL::~ESPSL() 
+{ 
+  if ((_batchCount > 0) && _sysLog) { flushLog(); }
+  if (_fwdUdp != NULL)              { saveForwardState(); }
+
+  freeBatch();    //-- not the one in RTC memory
+  free(_resIDs);
+  free(_contBefore);
+  free(_idxBloom);
+  free(_msgBuff);   //-- _lineBuff is part of it
+  delete _fwdUdp;
+  if (_arcReadIdx >= 0) { _arcRead.close(); }
+  if (_sysLog)          { _sysLog.close(); }
+#if defined(ESP32)
+  vSemaphoreDelete(_fileLock);
+#endif
 }
 
 //-------------------------------------------------------------------------------------
 //-- begin object
 boolean ESPSL::begin(uint16_t depth, uint16_t lineWidth) 
 {
-  uint32_t  tmpID, recKey;
+  ESPSL_rec::Meta meta;
+  uint32_t  started = micros();
+  int32_t   fileSize;
+  boolean   isValid = false;
   
 #ifdef _DODEBUG
   if (_Debug(1)) printf("ESPSL(%d)::begin(%d, %d)..\n", __LINE__, depth, lineWidth);
 #endif
 
-  int16_t fileSize;
+  if ((_batchCount > 0) && _sysLog) { flushLog(); }
+  if (_retainLines > depth) { _retainLines = depth; }
 
   if (lineWidth > _MAXLINEWIDTH) { lineWidth = _MAXLINEWIDTH; }
   if (lineWidth < _MINLINEWIDTH) { lineWidth = _MINLINEWIDTH; }
-  memset(globalBuff, 0, (_MAXLINEWIDTH +15));
+  memset(globalBuff, 0, sizeof(globalBuff));
   
   //-- check if the file exists ---
   if (!SPIFFS.exists(_sysLogFile)) 
@@ -54,55 +99,61 @@ boolean ESPSL::begin(uint16_t depth, uint16_t lineWidth)
     printf("ESPSL(%d)::begin(): Some error opening [%s] .. bailing out!\r\n", __LINE__, _sysLogFile);
     return false;
   } //-- if (!_sysLog)
+  _startOpenUs = micros() - started;
+  started      = micros();
 
-  if (_sysLog.available() > 0) 
+  //-- validate: record 0 (magic, version and geometry) and the size of the file
+  fileSize = _sysLog.size();
+  if ((fileSize > 0) && _sysLog.seek(0, SeekSet)) 
   {
 #ifdef _DODEBUG
     if (_Debug(3)) printf("ESPSL(%d)::begin(): read record [0]\r\n", __LINE__);
 #endif
-    if (!_sysLog.seek(0, SeekSet)) 
-    {
-      printf("ESPSL(%d)::begin(): seek to position [%04d] failed (now @%d)\r\n", __LINE__
-                                                                               , 0
-                                                                               , _sysLog.position());
-    }
-
-    int l = _sysLog.readBytesUntil('\n', globalBuff, _MAXLINEWIDTH) -1; 
-        //printf("ESPSL(%d)::begin(): rec[0] [%s]\r\n", __LINE__, globalBuff);
-
+    int l = _sysLog.readBytesUntil('\n', globalBuff, _MAXLINEWIDTH);
+    globalBuff[l] = '\0';
 #ifdef _DODEBUG
-        if (_Debug(4)) printf("ESPSL(%d)::begin(): rec[0] [%s]\r\n", __LINE__, globalBuff);
+    if (_Debug(4)) printf("ESPSL(%d)::begin(): rec[0] [%s]\r\n", __LINE__, globalBuff);
 #endif
-        sscanf(globalBuff,"%u|%d;%d;%d;" 
-                                , &recKey
-                                , &tmpID
-                                , &_numLines
-                                , &_lineWidth);
-     //printf("ESPSL(%d)::begin(): rec[%d] numLines[%d], lineWidth[%d]\r\n", __LINE__
-     //                                                                       , recKey
-     //                                                                       , _numLines
-     //                                                                       , _lineWidth);
-    Serial.flush();
-    if (_numLines   < _MINNUMLINES)  { _numLines   = _MINNUMLINES; }
-    if (_lineWidth  < _MINLINEWIDTH) { _lineWidth  = _MINLINEWIDTH; }
-    _recLength = _lineWidth + _KEYLEN;
-    //if (tmpID > _lastUsedLineID) { _lastUsedLineID = tmpID; }
+    isValid = ESPSL_rec::parseMeta(globalBuff, &meta);
+  } 
+  if (isValid)
+  {
+    _generation  = meta.generation;
+    _numLines    = meta.numLines;
+    _lineWidth   = meta.lineWidth;
+    _numReserved = meta.numReserved;   //-- older logfiles have no reserved region
+    _recLength   = _lineWidth + _KEYLEN;
+    isValid = (_lineWidth >= _MINLINEWIDTH) && (_lineWidth <= _MAXLINEWIDTH);
+  }
+  if (isValid && (fileSize < ((_numLines + _numReserved + 1) * (_recLength +1))))  //-- add '\n'
+  {
+    printf("ESPSL(%d)::begin(): [%s] size is [%d] but should be [%d] .. error!\r\n", __LINE__
+                                                          , _sysLogFile
+                                                          , fileSize
+                                                          , ((_numLines + _numReserved + 1) * (_recLength +1)));
+    isValid = false;
+  }
 #ifdef _DODEBUG
-    if (_Debug(4)) printf("ESPSL(%d)::begin(): rec[%u] -> [%8d][%d][%d]\r\n", __LINE__
-                                                                                , recKey
-                                                                                , _lastUsedLineID
+  if (_Debug(4)) printf("ESPSL(%d)::begin(): rec[0] -> valid[%d] [%d][%d][%d] version[%d]\r\n", __LINE__
+                                                                                , isValid
                                                                                 , _numLines
-                                                                                , _lineWidth);
+                                                                                , _lineWidth
+                                                                                , _numReserved
+                                                                                , meta.version);
 #endif
-  } 
-  
-  if ((depth != _numLines) || lineWidth != _lineWidth)
+  _startValidateUs = micros() - started;
+  started          = micros();
+
+  if (!isValid || (depth != _numLines) || (lineWidth != _lineWidth) || (_retainLines != _numReserved))
   {
-    if (_Debug(1)) printf("ESPSL(%d)::begin(): (depth[%d] != numLines[%d]) || (lineWidth[%d] != _lineWidth[%d])\r\n", __LINE__
+    if (_Debug(1)) printf("ESPSL(%d)::begin(): valid[%d] (depth[%d] != numLines[%d]) || (lineWidth[%d] != _lineWidth[%d]) || (reserved[%d] != [%d])\r\n", __LINE__
+                                              , isValid
                                               , depth
                                               , _numLines
                                               , lineWidth
-                                              , _lineWidth);
+                                              , _lineWidth
+                                              , _retainLines
+                                              , _numReserved);
     _sysLog.close();
     removeSysLog();
     create(depth, lineWidth);
@@ -117,19 +168,74 @@ boolean ESPSL::begin(uint16_t depth, uint16_t lineWidth)
   
   memset(globalBuff, 0, sizeof(globalBuff));
   
-  checkSysLogFileSize("begin():", (_numLines + 1) * (_recLength +1));  //-- add '\n'
-  
-  if (_numLines != depth) 
+  init();
+  //printf("ESPSL(%d):: after init() -> _lastUsedLineID[%d]\r\n", __LINE__, _lastUsedLineID);
+
+  //-- flash geometry for the wear estimation
+#if defined(ESP8266)
+  FSInfo fsInfo;
+  if (SPIFFS.info(fsInfo) && (fsInfo.blockSize > 0))
   {
-    printf("ESPSL(%d)::begin(): lines in file (%d) <> %d !!\r\n", __LINE__, _numLines, depth);
+    _fsPageSize  = fsInfo.pageSize;
+    _fsBlockSize = fsInfo.blockSize;
+    _fsBlocks    = fsInfo.totalBytes / fsInfo.blockSize;
   }
-  if (_lineWidth != lineWidth)
+#else
+  _fsBlocks = SPIFFS.totalBytes() / _fsBlockSize;
+#endif
+  freeBatch();    //-- _recLength might have changed
+  if (_sleepBytes > 0)
   {
-    printf("ESPSL(%d)::begin(): lineWidth in file (%d) <> %d !!\r\n", __LINE__, _lineWidth, lineWidth);
+    _batchMin = sleepBatchSize();
+    _batchMax = _batchMin;
   }
-
-  init();
-  //printf("ESPSL(%d):: after init() -> _lastUsedLineID[%d]\r\n", __LINE__, _lastUsedLineID);
+  _wearStart    = millis();
+  _wearWinStart = _wearStart;
+
+  if (_idxEnabled)   { loadIndex(); }
+  if (_mSeries > 0)  { loadMetrics(); }
+  if (_arcFiles > 0) { loadArchive(); }
+#if defined(ESP32)
+  uint16_t lostRecords = 0;
+  if (   (_rtcBatch.magic == _RTCMAGIC) && (_rtcBatch.count > 0)
+      && (_rtcBatch.check == ((uint32_t)_RTCMAGIC ^ _rtcBatch.firstID ^ _rtcBatch.recLength ^ _rtcBatch.count)) )
+  {
+    //-- records held before the (deep) sleep are still in RTC memory. They follow the
+    //-- ring, warnings and errors among them are already in the reserved region
+    if (   (_sleepBytes > 0) && (_batchMax > 1) && (_rtcBatch.recLength == _recLength)
+        && (_rtcBatch.firstID == (_ringLastID +1)) && (_rtcBatch.count <= _batchMax)
+        && ((_rtcBatch.firstID + _rtcBatch.count -1) >= _lastUsedLineID) )
+    {
+      _batchBuff   = _rtcBatch.records;
+      _batchSize   = _batchMax;
+      _batchCount  = _rtcBatch.count;
+      _batchSince  = millis();
+      _batchLast   = _batchSince;
+      for (uint16_t r = 0; (_idxBloom != NULL) && (r < _batchCount); r++)
+      {
+        char *batchRec = _batchBuff + (r * (_recLength +1));
+        indexRecord(((_rtcBatch.firstID +r) % _numLines), (batchRec + _KEYLEN), batchRec[_KEYLEN -1]);
+      }
+      _lastUsedLineID = _rtcBatch.firstID + _batchCount -1;
+      _oldestLineID   = _lastUsedLineID +1;
+    }
+    else
+    {
+      lostRecords     = _rtcBatch.count;
+      _rtcBatch.magic = 0;
+      printf("ESPSL(%d)::begin(): [%d] records held in RTC memory (lineID %d ..) do not fit, dropped\r\n"
+                                                , __LINE__, lostRecords, _rtcBatch.firstID);
+    }
+  }
+#endif
+  _startRecoverUs = micros() - started;
+  startSession();
+#if defined(ESP32)
+  if (lostRecords > 0) 
+  {
+    writefLevel(ESPSL_LEVEL_WARNING, "ESPSL: [%d] records held in RTC memory are lost", lostRecords);
+  }
+#endif
 
   return true; // We're all setup!
   
@@ -175,6 +281,7 @@ boolean ESPSL::create(uint16_t depth, uint16_t lineWidth)
   _lineWidth  = lineWidth;
   
   _recLength  = _lineWidth + _KEYLEN;
+  _numReserved = _retainLines;
 
   //_nextFree = 0;
   memset(globalBuff, 0, sizeof(globalBuff));  
@@ -188,13 +295,18 @@ boolean ESPSL::create(uint16_t depth, uint16_t lineWidth)
   } //-- if (!_sysLog)
 
 
-  snprintf(globalBuff, _lineWidth, "%08d;%d;%d; META DATA SPIFFS_SysLogger", 0, _numLines, _lineWidth);
-  fixLineWidth(globalBuff, _lineWidth);
-  fixRecLen(globalBuff, 0, _recLength);
+  //-- a new generation tells forward() (and others) this is not the old logfile
+#if defined(ESP8266)
+  _generation = 1 + (RANDOM_REG32 % 99999999);
+#else
+  _generation = 1 + (esp_random() % 99999999);
+#endif
+  snprintf(globalBuff, _lineWidth, "%08d;%d;%d;%d;%d;" _METAMAGIC " SPIFFS_SysLogger", _generation, _numLines
+                                                                    , _lineWidth, _numReserved, _METAVERSION);
 #ifdef _DODEBUG
   if (_Debug(1)) printf("ESPSL(%d)::create(): rec(0) [%s](%d bytes)\r\n", __LINE__, globalBuff, strlen(globalBuff));
 #endif
-  bytesWritten = createFile.println(globalBuff) -1; //-- skip '\n'
+  bytesWritten = printRecord(createFile, 0, _RECTEXT, globalBuff);
   createFile.flush();
   if (bytesWritten != _recLength) 
   {
@@ -206,14 +318,12 @@ boolean ESPSL::create(uint16_t depth, uint16_t lineWidth)
   }
   
   int r;
-  for (r=0; r < _numLines; r++) 
+  for (r=0; r < (_numLines + _numReserved); r++) 
   {
     yield();
     snprintf(globalBuff, _lineWidth, "=== empty log regel (%d) ========================================================================================", (r+1));
-    fixLineWidth(globalBuff, _lineWidth);
-    fixRecLen(globalBuff, (_EMPTYID *1), _recLength);
     //printf("ESPSL(%d)::create(): rec(%d) [%s](%d bytes)\r\n", __LINE__, r, globalBuff, strlen(globalBuff));
-    bytesWritten = createFile.println(globalBuff) -1; //-- skip '\n'
+    bytesWritten = printRecord(createFile, _EMPTYID, _RECTEXT, globalBuff);
     if (bytesWritten != _recLength) 
     {
       printf("ESPSL(%d)::create(): ERROR!! written [%d] bytes but should have been [%d] for record [%d]\r\n"
@@ -229,6 +339,15 @@ boolean ESPSL::create(uint16_t depth, uint16_t lineWidth)
   _lastUsedLineID = 1;
   _oldestLineID   = 0;
 
+  //-- lineID's start over, so does forwarding
+  SPIFFS.remove(_fwdFile);
+  SPIFFS.remove(_idxFile);
+  SPIFFS.remove(_bootFile);
+  removeArchive();
+  _fwdLastID      = 0;
+  _fwdSavedID     = 0;
+  _fwdGeneration  = _generation;
+
     return true;
   
 } // create()
@@ -238,9 +357,6 @@ boolean ESPSL::create(uint16_t depth, uint16_t lineWidth)
 boolean ESPSL::init() 
 {
   int32_t offset, recKey = 0;
-  int32_t readKey;
-  char logText[(_lineWidth + _KEYLEN +1)];
-  memset(logText, 0, (_lineWidth + _KEYLEN +1));
 
 #ifdef _DODEBUG
   if (_Debug(1)) printf("ESPSL(%d)::init()..\r\n", __LINE__);
@@ -255,8 +371,11 @@ boolean ESPSL::init()
   _oldestLineID   = 0;
   _lastUsedLineID = 0;
   recKey          = 0;
+  free(_contBefore);
+  _contBefore     = NULL;
+  _contWritten    = 0;
 
-  while (_sysLog.available() > 0) 
+  while ((_sysLog.available() > 0) && (recKey < _numLines))
   {
     recKey++;
     offset = (recKey * (_recLength +1)); 
@@ -271,22 +390,69 @@ boolean ESPSL::init()
     if (_Debug(4)) printf("ESPSL(%d)::init(): -> read record (recKey) [%d/%04d]\r\n", __LINE__, recKey, offset);
 #endif
     int l = _sysLog.readBytesUntil('\n', globalBuff, _recLength);
-        sscanf(globalBuff,"%u|%[^\0]" , &_oldestLineID, logText);
+        globalBuff[l] = '\0';
+        _oldestLineID = atol(globalBuff);   //-- stops at the separator
         if (_oldestLineID > 0)
         {
           if (_oldestLineID >= _lastUsedLineID) { _lastUsedLineID = _oldestLineID; }
           //printf("ESPSL(%d):: init() -> _lastUsedLineID[%d] _oldestLineID[%d]\r\n", __LINE__, _lastUsedLineID, _oldestLineID);
         }
+        //-- mark the continuation records, counted below
+        if ((_oldestLineID > 0) && (l >= _KEYLEN) && (globalBuff[_KEYLEN -1] == _RECCONT))
+        {
+          if (_contBefore == NULL) { _contBefore = (uint16_t*)calloc(_numLines, sizeof(uint16_t)); }
+          if (_contBefore != NULL) { _contBefore[recKey -1] = 1; }
+        }
     
 #ifdef _DODEBUG
-    if (_Debug(4)) printf("ESPSL(%d)::init(): testing readKey[%010u] -> [%08d][%s]\r\n", __LINE__
+    if (_Debug(4)) printf("ESPSL(%d)::init(): testing lineID[%08d][%s]\r\n", __LINE__
                                                                                 , _oldestLineID
-                                                                                , logText);
+                                                                                , (globalBuff + _KEYLEN));
 #endif
   } //-- while ..
   
+  _ringLastID = _lastUsedLineID;
+
+  //-- lineID's in the reserved region, continue after the newest one
+  free(_resIDs);
+  _resIDs  = NULL;
+  _resNext = 0;
+  if (_numReserved > 0)
+  {
+    _resIDs = (int32_t*)malloc(_numReserved * sizeof(int32_t));
+    if (_resIDs == NULL) 
+    {
+      printf("ESPSL(%d)::init(): no memory for [%d] reserved lines\r\n", __LINE__, _numReserved);
+    }
+  }
+  for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
+  {
+    _resIDs[r] = _EMPTYID;
+    offset = ((_numLines +1 +r) * (_recLength +1)); 
+    if (!_sysLog.seek(offset, SeekSet)) { continue; }
+    int l = _sysLog.readBytesUntil('\n', globalBuff, _recLength);
+    globalBuff[l] = '\0';
+    _resIDs[r] = atol(globalBuff);
+    //-- the ring record might not have been flushed
+    if (_resIDs[r] > _lastUsedLineID) { _lastUsedLineID = _resIDs[r]; }
+  }
+  //-- the slot after the newest one is the oldest (or still empty)
+  for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
+  {
+    if (_resIDs[r] > _resIDs[(_resNext + _numReserved -1) % _numReserved]) { _resNext = (r +1) % _numReserved; }
+  }
+
   if (_lastUsedLineID <= 0) { _lastUsedLineID = 0; }
   _oldestLineID = _lastUsedLineID +1;
+
+  //-- continuation records written before every lineID in the ring (oldest first)
+  for (int32_t lineID = ((_lastUsedLineID < _numLines) ? 1 : (_lastUsedLineID - _numLines +1));
+                                      (_contBefore != NULL) && (lineID <= _lastUsedLineID); lineID++)
+  {
+    uint16_t isCont = _contBefore[lineID % _numLines];
+    _contBefore[lineID % _numLines] = _contWritten;
+    _contWritten += isCont;
+  }
   //printf("ESPSL(%d):: init() => _lastUsedLineID[%d] _oldestLineID[%d]\r\n", __LINE__, _lastUsedLineID, _oldestLineID);
 
   return false;
@@ -301,9 +467,50 @@ boolean ESPSL::write(const char* logLine)
   if (_Debug(3)) printf("ESPSL(%d)::write(%s)..\r\n", __LINE__, logLine);
 #endif
 
+  return writeLine(logLine, _RECTEXT);
+
+} // write()
+
+
+//-------------------------------------------------------------------------------------
+//-- filter and write a line of type recType
+boolean ESPSL::writeLine(const char* logLine, char recType) 
+{
+  boolean retVal = true;
+
+  _LOCKFILE();
+  if ((_dedupMode == ESPSL_DEDUP_OFF) || !isDuplicate(logLine, recType))
+  {
+    //-- the part that does not fit goes to continuation records
+    int textLen = strnlen(logLine, msgLength());
+    int chunk   = (_lineWidth -1);
+
+    retVal = writeRecord(logLine, recType, (textLen > chunk));
+    for (int p = chunk; retVal && (p < textLen); p += chunk)
+    {
+      retVal = writeRecord((logLine + p), _RECCONT, ((p + chunk) < textLen));
+    }
+    //-- the adaptive policy never holds a warning or error only in RAM
+    if (   retVal && (_wearBudget > 0.0) && (_resIDs == NULL)
+        && ((recType == _RECWARNING) || (recType == _RECERROR)) )
+    {
+      retVal = flushLog();
+    }
+  }
+  _UNLOCKFILE();
+
+  return retVal;
+
+} // writeLine()
+
+
+//-------------------------------------------------------------------------------------
+//-- write logLine to the next free slot (no filtering), more -> the next record
+//-- continues this one
+boolean ESPSL::writeRecord(const char* logLine, char recType, boolean more) 
+{
   int32_t   bytesWritten;
-  uint16_t  offset, seekToLine;
-  int       nextFree;
+  uint32_t  offset, seekToLine;
 
   //_sysLog  = SPIFFS.open(_sysLogFile, "r+");    //-- open for reading and writing
 
@@ -312,23 +519,84 @@ boolean ESPSL::write(const char* logLine)
                                                       , __LINE__
                                                       , _oldestLineID
                                                       , _lastUsedLineID
-                                                      , nextFree);
+                                                      , (((_lastUsedLineID +1) % _numLines) +1));
 #endif
   
-  char lineBuff[(_recLength + _KEYLEN +1)];
-  memset(globalBuff, 0, (_recLength + _KEYLEN + 1));
+  if ((_batchMax > 1) && (_batchSize < _batchMax))
+  {
+    //-- (re)allocate the batch buffer (adaptive policy may have widened it)
+    flushLog();
+    freeBatch();
+#if defined(ESP32)
+    if (_sleepBytes > 0)  { _batchBuff = _rtcBatch.records; }
+    else
+#endif
+    _batchBuff = (char*)malloc(_batchMax * (_recLength +1));
+    _batchSize = (_batchBuff == NULL) ? 0 : _batchMax;
+  }
+
+  //-- the writer starts on a block of slots: the lines in it go to the archive first
+  //-- (before _lastUsedLineID moves on, so records held in the batch are found)
+  if (   (_arcFiles > 0) && ((_lastUsedLineID +1) >= _numLines) 
+      && ((((_lastUsedLineID +1) % _numLines) % _ARCBLOCK) == 0) )
+  {
+    uint32_t slot   = ((_lastUsedLineID +1) % _numLines);
+    int32_t  fromID = ((_lastUsedLineID +1) - _numLines);
+    uint32_t slots  = ((_numLines - slot) < _ARCBLOCK) ? (_numLines - slot) : _ARCBLOCK;
+
+    archiveBlock(fromID, (fromID + slots -1));
+  }
 
-  snprintf(globalBuff, _lineWidth, "%s", logLine);
-  fixLineWidth(globalBuff, _lineWidth); 
   _lastUsedLineID++;
-  fixRecLen(globalBuff, _lastUsedLineID, _recLength);
+  _statRecords++;
+
+  //-- ESPSL_Reader leaves continuation records out of the lines it skipped
+  if ((_contBefore == NULL) && (recType == _RECCONT)) 
+  {
+    _contBefore = (uint16_t*)calloc(_numLines, sizeof(uint16_t));
+  }
+  if (_contBefore != NULL) { _contBefore[_lastUsedLineID % _numLines] = _contWritten; }
+  if (recType == _RECCONT) { _contWritten++; }
+
+  //-- a continued line is indexed as a whole with its first record
+  if ((_idxBloom != NULL) && (recType != _RECCONT)) 
+  {
+    indexRecord((_lastUsedLineID % _numLines), logLine, recType); 
+  }
+  if (((recType == _RECWARNING) || (recType == _RECERROR)) && (_resIDs != NULL))
+  {
+    writeReserved(logLine, recType);
+  }
+
+  if ((_batchMax > 1) && (_batchSize >= _batchMax))
+  {
+    //-- keep the record in RAM, flushLog() writes it to flash
+    char *batchRec = _batchBuff + (_batchCount * (_recLength +1));
+    fixRecKey(batchRec, _lastUsedLineID, recType);
+    fixRecText(batchRec + _KEYLEN, logLine);
+    batchRec[_recLength -1] = (more ? _RECMORE : '\r');
+    batchRec[_recLength]    = '\n';
+    if (_batchCount == 0) { _batchSince = millis(); }
+    _batchLast = millis();
+    _batchCount++;
+    _oldestLineID = _lastUsedLineID +1;
+    keepBatch();
+
+    if (   (_batchCount >= _batchMax)
+        || ((_flushDelay > 0) && ((millis() - _batchSince) >= _flushDelay)) )
+    {
+      return flushLog();
+    }
+    return true;
+  }
+
   seekToLine = (_lastUsedLineID % _numLines) +1; //-- always skip rec. 0 (status rec)
   offset = (seekToLine * (_recLength +1));
 #ifdef _DODEBUG
   if (_Debug(4)) printf("ESPSL(%d)::write() -> slot[%d], seek[%d/%04d] [%s]\r\n", __LINE__
                                                                                 , _lastUsedLineID
                                                                                 , seekToLine, offset
-                                                                                , lineBuff);
+                                                                                , logLine);
 #endif
   if (!_sysLog.seek(offset, SeekSet)) 
   {
@@ -338,9 +606,16 @@ boolean ESPSL::write(const char* logLine)
     //_sysLog.close();
     return false;
   }
-  bytesWritten = _sysLog.println(globalBuff) -1; // don't count '\n'
+  uint32_t started = micros();
+  bytesWritten = printRecord(_sysLog, _lastUsedLineID, recType, logLine, more);
   _sysLog.flush();
+  _statFlashUs += (micros() - started);
   //_sysLog.close();
+  countFlashWrite(offset, (_recLength +1));
+  _statFlushes++;
+  _statPages++;       //-- SPIFFS also rewrites the object index page
+  _wearWinPages++;
+  adaptFlushPolicy();
 
   if (bytesWritten != _recLength) 
   {
@@ -350,441 +625,3175 @@ boolean ESPSL::write(const char* logLine)
   }
 
   _oldestLineID = _lastUsedLineID +1; //-- 1 after last
-  nextFree = (_lastUsedLineID % _numLines) + 1;  //-- always skip rec "0"
 
   return true;
 
-} // write()
+} // writeRecord()
 
 
 //-------------------------------------------------------------------------------------
-boolean ESPSL::writef(const char *fmt, ...) 
+//-- keep a copy of a warning or error in the reserved region (the oldest copy is 
+//-- overwritten), so a flood of info and debug lines cannot push it out of the log
+void ESPSL::writeReserved(const char* logLine, char recType) 
 {
-  char lineBuff[(_MAXLINEWIDTH + 101)];
-  memset(lineBuff, 0, (_MAXLINEWIDTH + 101));
+  uint32_t  seekToLine = _numLines +1 +_resNext;
+  uint32_t  offset     = (seekToLine * (_recLength +1));
 
 #ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d)::writef(%s)..\r\n", __LINE__, fmt);
+  if (_Debug(4)) printf("ESPSL(%d)::writeReserved() -> slot[%d], seek[%d/%04d]\r\n", __LINE__
+                                                                                , _lastUsedLineID
+                                                                                , seekToLine, offset);
 #endif
-
-  va_list args;
-  va_start (args, fmt);
-  vsnprintf (lineBuff, (_MAXLINEWIDTH +100), fmt, args);
-  va_end (args);
-
-  //-- remove control chars
-  for(int i=0; ((i<strlen(lineBuff)) && (lineBuff[i]!=0)); i++)
+  if (!_sysLog.seek(offset, SeekSet)) 
   {
-    if ((lineBuff[i] < ' ') || (lineBuff[i] > '~')) { lineBuff[i] = '^'; }
+    printf("ESPSL(%d)::writeReserved(): seek to position [%d/%04d] failed (now @%d)\r\n", __LINE__, seekToLine
+                                                                                        , offset
+                                                                                        , _sysLog.position());
+    return;
   }
+  uint32_t started = micros();
+  printRecord(_sysLog, _lastUsedLineID, recType, logLine);
+  _sysLog.flush();
+  _statFlashUs += (micros() - started);
+  countFlashWrite(offset, (_recLength +1));
+  _statFlushes++;
+  _statPages++;
 
-  bool retVal = write(lineBuff);
-
-  return retVal;
+  _resIDs[_resNext] = _lastUsedLineID;
+  _resNext = (_resNext +1) % _numReserved;
+  if (_idxBloom != NULL) { indexText((_idxBloom + (2 * _IDXBYTES)), logLine, recType); }
 
-} // writef()
+} // writeReserved()
 
 
 //-------------------------------------------------------------------------------------
-boolean ESPSL::writeDbg(const char *dbg, const char *fmt, ...) 
+//-- record (slot) in the file that holds lineID, 0 if it is no longer in the log
+uint32_t ESPSL::slotOf(int32_t lineID) 
 {
-#ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d)::writeDbg(%s, %s)..\r\n", __LINE__, dbg, fmt);
-#endif
+  if ((lineID < 1) || (lineID > _lastUsedLineID))   { return 0; }
+  if (lineID > (_lastUsedLineID - _numLines))       { return ((lineID % _numLines) +1); }
 
-  int       nextFree;
-  char dbgStr[(_MAXLINEWIDTH + 101)];
-  memset(dbgStr, 0, (_MAXLINEWIDTH + 101));
-  char totBuf[(_MAXLINEWIDTH + 101)];
-  memset(totBuf, 0, (_MAXLINEWIDTH + 101));
-
-  sprintf(dbgStr, "%s", dbg);
-  //printf("ESPSL(%d)::writeDbg([%s], *fmt)..\r\n", __LINE__, dbgStr);
-  
-  va_list args;
-  va_start (args, fmt);
-  vsnprintf (totBuf, (_MAXLINEWIDTH +100), fmt, args);
-  va_end (args);
-  
-  while ((strlen(totBuf) > 0) && (strlen(dbgStr) + strlen(totBuf)) > (_lineWidth -1)) 
+  for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
   {
-    totBuf[strlen(totBuf)-1] = '\0';
-    yield();
+    if (_resIDs[r] == lineID) { return (_numLines +1 +r); }
   }
-  if ((strlen(dbgStr) + strlen(totBuf)) < _lineWidth) 
+  return 0;
+
+} // slotOf()
+
+
+//-------------------------------------------------------------------------------------
+//-- first lineID >= fromID that is still in the log (> _lastUsedLineID if none), 
+//-- withArchive -> or in the archive
+int32_t ESPSL::nextLineID(int32_t fromID, boolean withArchive) 
+{
+  int32_t ringOldest = (_lastUsedLineID < _numLines) ? 1 : (_lastUsedLineID - _numLines +1);
+  int32_t nextID     = ringOldest;
+  int32_t arcOldest  = (withArchive ? archiveOldestID() : 0);
+
+  if (fromID >= ringOldest) { return fromID; }
+  if ((arcOldest > 0) && (fromID <= _arcLastID))
   {
-    strlcat(dbgStr, totBuf, _lineWidth);
+    if (fromID >= arcOldest)  { return fromID; }
+    if (arcOldest < nextID)   { nextID = arcOldest; }
   }
-
-  //-- remove control chars
-  for(int i=0; ((i<strlen(dbgStr)) && (dbgStr[i]!=0)); i++)
+  for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
   {
-    if ((dbgStr[i] < ' ') || (dbgStr[i] > '~')) { dbgStr[i] = '^'; }
+    if ((_resIDs[r] >= fromID) && (_resIDs[r] < nextID)) { nextID = _resIDs[r]; }
   }
-  //printf("ESPSL(%d)::writeDbg(): dbgStr[%s]..\r\n", __LINE__, dbgStr);
-  bool retVal = write(dbgStr);
-  
-  return retVal;
+  return nextID;
 
-} // writeDbg()
+} // nextLineID()
 
 
 //-------------------------------------------------------------------------------------
-char *ESPSL::buildD(const char *fmt, ...) 
+//-- last lineID <= fromID that is still in the log or in the archive (0 if none)
+int32_t ESPSL::prevLineID(int32_t fromID) 
 {
-#ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d)::buildD(%s)..\r\n", __LINE__, fmt);
-#endif
-  memset(globalBuff, 0, sizeof(globalBuff));
-  
-  va_list args;
-  va_start (args, fmt);
-  vsnprintf (globalBuff, (_MAXLINEWIDTH), fmt, args);
-  va_end (args);
+  int32_t ringOldest = (_lastUsedLineID < _numLines) ? 1 : (_lastUsedLineID - _numLines +1);
+  int32_t prevID     = 0;
 
-  //-- remove control chars
-  for(int i=0; ((i<strlen(globalBuff)) && (globalBuff[i]!=0)); i++)
+  if (fromID > _lastUsedLineID) { fromID = _lastUsedLineID; }
+  if (fromID >= ringOldest)     { return fromID; }
+  if ((archiveOldestID() > 0) && (fromID >= archiveOldestID()))
   {
-    if ((globalBuff[i] < ' ') || (globalBuff[i] > '~')) { globalBuff[i] = '^'; }
+    if (fromID <= _arcLastID) { return fromID; }
+    prevID = _arcLastID;
   }
+  for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
+  {
+    if ((_resIDs[r] <= fromID) && (_resIDs[r] > prevID)) { prevID = _resIDs[r]; }
+  }
+  return prevID;
 
-  return globalBuff;
-  
-} // buildD()
-
+} // prevLineID()
 
 //-------------------------------------------------------------------------------------
-//-- set pointer to startLine
-void ESPSL::startReading() 
+//-- continuation records written before lineID, only known for the lines in the ring
+//-- (the count wraps, only the difference between two counts means something)
+boolean ESPSL::contBefore(int32_t lineID, uint16_t *count) 
 {
-  _readNext         = _lastUsedLineID +1;
-  _readNextEnd      = _readNext + _numLines;
-  _readPrevious     = _lastUsedLineID;
-  _readPreviousEnd  = _readPrevious - _numLines;
-  if (_readPreviousEnd < 0) { _readPreviousEnd = 0; }
-#ifdef _DODEBUG
-  if (_Debug(1)) printf("ESPSL(%d)::startReading()..next[%d] to [%d]\r\n", __LINE__, _readNext, _readNextEnd);
-  if (_Debug(1)) printf("ESPSL(%d)::startReading()..prev[%d] to [%d]\r\n", __LINE__, _readPrevious, _readPreviousEnd);
-#endif
+  if (lineID == (_lastUsedLineID +1))  { *count = _contWritten; return true; }
+  if ((lineID < 1) || (lineID > _lastUsedLineID) || (lineID <= (_lastUsedLineID - _numLines))) 
+  {
+    return false;
+  }
+  //-- no array -> no continuation records were written since init()
+  *count = (_contBefore == NULL) ? _contWritten : _contBefore[lineID % _numLines];
+  return true;
+
+} // contBefore()
 
-} // startReading()
 
 //-------------------------------------------------------------------------------------
-//-- start reading from _readNext
-bool ESPSL::readNextLine(char *lineOut, int lineOutLen)
+//-- write a record (key, text padded to _lineWidth -1 chars, "\r\n") to recFile
+//-- piece by piece, so the record is never copied to a buffer first
+//-- returns the bytes written minus the '\n' (like println() -1)
+int32_t ESPSL::printRecord(File &recFile, int32_t recKey, char recType, const char *text, boolean more) 
 {
-  uint32_t  offset;
-  int32_t   recKey = _readNext;
-  int32_t   lineID;
-  uint16_t  seekToLine;  
-  char      lineIn[_recLength];
-  
-#ifdef _DODEBUG
-  if (_Debug(1)) printf("ESPSL(%d)::readNextLine(%d)\r\n", __LINE__, _readNext);
-#endif
-  memset(globalBuff, 0, (_recLength+10));
-  memset(lineIn, 0, _recLength);
+  char      keyBuff[_KEYLEN +1];
+  int32_t   bytesWritten;
+  int       p = 0, run;
 
-  if (_readNext >= _readNextEnd) return false;
-  
-  if (!_sysLog)
+  fixRecKey(keyBuff, recKey, recType);
+  bytesWritten = recFile.write((const uint8_t*)keyBuff, _KEYLEN);
+  //-- write the text in runs, control chars are replaced by '^'
+  while ((p < (_lineWidth -1)) && (text[p] != '\0'))
   {
-    printf("ESPSL(%d)::readNextLine(): _sysLog (%s) not open\r\n", __LINE__, _sysLogFile);
-  }
-  for(int r=0; r<_numLines; r++)
-  {
-    seekToLine = ((_readNext +r) % _numLines) +1;
-    offset     = (seekToLine * (_recLength +1));
-    if (!_sysLog.seek(offset, SeekSet)) 
+    for (run = 0; ((p + run) < (_lineWidth -1)) && (text[p+run] >= ' ') && (text[p+run] <= '~'); run++) ;
+    if (run > 0)
     {
-      printf("ESPSL(%d)::readNextLine(): seek to position [%d/%04d] failed (now @%d)\r\n", __LINE__
-                                                                                         , seekToLine
-                                                                                         , offset
-                                                                                         , _sysLog.position());
-      return true;
+      bytesWritten += recFile.write((const uint8_t*)(text + p), run);
+      p += run;
     }
-
-    int l = _sysLog.readBytesUntil('\n', globalBuff, _recLength);
-      sscanf(globalBuff,"%u|%[^\0]", &lineID, lineIn);     
-
-#ifdef _DODEBUG
-    if (_Debug(4)) printf("ESPSL(%d)::readNextLine(): [%5d]->recNr[%010d][%10d]-> [%s]\r\n"
-                                                            , __LINE__
-                                                            , seekToLine
-                                                            , _readNext
-                                                            , lineID
-                                                            , lineIn);
-#endif
-    if (lineID > -1) { _readNext += r; break; }
-    
-  } // for ..
-    _readNext++;
-    if (lineID > (int)_EMPTYID) 
-    {
-      strlcpy(lineOut, rtrim(lineIn), lineOutLen);
-      return true;
-#ifdef _DODEBUG
-    } else 
+    else
     {
-      if (_Debug(4)) printf("ESPSL(%d)::readNextLine(): SKIP[%s]\r\n", __LINE__, lineIn);
-#endif
+      bytesWritten += recFile.write((uint8_t)'^');
+      p++;
     }
+  }
+  //-- add spaces at the end
+  for (; p < (_lineWidth -1); p += run)
+  {
+    run = (_lineWidth -1) - p;
+    if (run > (int)(sizeof(_SPACES) -1)) { run = sizeof(_SPACES) -1; }
+    bytesWritten += recFile.write((const uint8_t*)_SPACES, run);
+  }
+  bytesWritten += recFile.write((uint8_t)(more ? _RECMORE : '\r'));
+  bytesWritten += recFile.write((uint8_t)'\n');
 
-  return false;
+  return (bytesWritten -1);
+
+} // printRecord()
 
-} //  readNextLine()
 
 //-------------------------------------------------------------------------------------
-//-- start reading from _readNext
-bool ESPSL::readPreviousLine(char *lineOut, int lineOutLen)
+//-- "%010d" followed by recType, without snprintf()
+void ESPSL::fixRecKey(char *keyOut, int32_t recKey, char recType) 
 {
-  uint32_t  offset;
-  int32_t   recKey = _readNext;
-  int32_t   lineID;
-  uint16_t  seekToLine;  
-  //File      tmpFile;
-  char      lineIn[_recLength];
-  
-#ifdef _DODEBUG
-  if (_Debug(1)) printf("ESPSL(%d)::readPreviousLine(%d/%d)\r\n", __LINE__, _readPrevious, _readPreviousEnd);
-#endif
-  memset(globalBuff, 0, (_recLength+10));
-  memset(lineIn, 0, _recLength);
+  uint32_t  value = (recKey < 0) ? -recKey : recKey;
 
-  if (_readPrevious <= _readPreviousEnd) return false;
-  
-  if (!_sysLog)
+  for (int p = (_KEYLEN -2); p >= 0; p--)
   {
-    printf("ESPSL(%d)::readPreviousLine(): _sysLog (%s) not open\r\n", __LINE__, _sysLogFile);
+    keyOut[p] = '0' + (value % 10);
+    value /= 10;
   }
-  for(int r=0; r<_numLines; r++)
-  {
-    _readPrevious -= r;
-    if (_readPrevious < 0) return false;
-    seekToLine = (_readPrevious % _numLines) +1;
-    offset     = (seekToLine * (_recLength +1));
-    if (!_sysLog.seek(offset, SeekSet)) 
-    {
-      printf("ESPSL(%d)::readPreviousLine(): seek to position [%d/%04d] failed (now @%d)\r\n", __LINE__
-                                                                                         , seekToLine
-                                                                                         , offset
-                                                                                         , _sysLog.position());
-      return true;
-    }
+  if (recKey < 0) { keyOut[0] = '-'; }
+  keyOut[_KEYLEN -1] = recType;
+  keyOut[_KEYLEN]    = '\0';
 
-    int l = _sysLog.readBytesUntil('\n', globalBuff, _recLength);
-        sscanf(globalBuff,"%u|%[^\0]", &lineID, lineIn);     
+} // fixRecKey()
 
-#ifdef _DODEBUG
-    if (_Debug(4)) printf("ESPSL(%d)::readPreviousLine(): [%5d]->recNr[%010d][%10d]-> [%s]\r\n"
-                                                            , __LINE__
-                                                            , seekToLine
-                                                            , _readPrevious
-                                                            , lineID
-                                                            , lineIn);
-#endif
-    if (lineID > -1) { break; }
-    
-  } // for ..
-    
-  _readPrevious--;
-  if (lineID > (int)_EMPTYID) 
-  {
-    strlcpy(lineOut, rtrim(lineIn), lineOutLen);
-    return true;
-#ifdef _DODEBUG
-  } else 
+
+//-------------------------------------------------------------------------------------
+//-- copy text (control chars replaced by '^') padded with spaces to _lineWidth -1 chars
+void ESPSL::fixRecText(char *textOut, const char *text) 
+{
+  int p;
+
+  for (p = 0; (p < (_lineWidth -1)) && (text[p] != '\0'); p++)
   {
-    if (_Debug(4)) printf("ESPSL(%d)::readPreviousLine(): SKIP[%s]\r\n", __LINE__, lineIn);
-#endif
+    textOut[p] = ((text[p] < ' ') || (text[p] > '~')) ? '^' : text[p];
   }
+  memset(textOut + p, ' ', ((_lineWidth -1) - p));
 
-  return false;
+} // fixRecText()
 
-} //  readPreviousLine()
 
 //-------------------------------------------------------------------------------------
-//-- start reading from startLine
-bool ESPSL::dumpLogFile() 
+//-- write all records held in RAM to flash
+boolean ESPSL::flushLog() 
 {
+  uint32_t  offset, seekToLine, run, bytes;
+  int32_t   firstID;
+  uint16_t  r = 0;
+  boolean   retVal = true;
+  uint32_t  started;
+
+  if (_batchCount == 0) { return true; }
+
 #ifdef _DODEBUG
-  if (_Debug(1)) printf("ESPSL(%d)::dumpLogFile()..\r\n", __LINE__);
+  if (_Debug(3)) printf("ESPSL(%d)::flushLog() [%d] records..\r\n", __LINE__, _batchCount);
 #endif
 
-  int32_t   recKey;
-  uint32_t  offset, seekToLine;
-  memset(globalBuff, 0, sizeof(globalBuff));
-      
-  _sysLog  = SPIFFS.open(_sysLogFile, "r+");    //-- open for reading and writing
-
-  checkSysLogFileSize("dumpLogFile():", (_numLines + 1) * (_recLength +1));  //-- add '\n'
+  _LOCKFILE();
 
-  for (recKey = 0; recKey < _numLines; recKey++) 
+  started = micros();
+  firstID = _lastUsedLineID - _batchCount +1;
+  while (r < _batchCount)
   {
-    seekToLine = (recKey % _numLines)+1;
+    seekToLine = ((firstID + r) % _numLines) +1;
+    //-- consecutive slots up to the end of the ring are written in one go
+    run = _numLines - seekToLine +1;
+    if (run > (uint32_t)(_batchCount - r)) { run = _batchCount - r; }
     offset = (seekToLine * (_recLength +1));
+    bytes  = run * (_recLength +1);
     if (!_sysLog.seek(offset, SeekSet)) 
     {
-      printf("ESPSL(%d)::dumpLogFile(): seek to position [%d] (offset %d) failed (now @%d)\r\n", __LINE__
-                                                                                              , seekToLine
-                                                                                              , offset
-                                                                                              , _sysLog.position());
-      return false;
+      printf("ESPSL(%d)::flushLog(): seek to position [%d/%04d] failed (now @%d)\r\n", __LINE__, seekToLine
+                                                                                     , offset
+                                                                                     , _sysLog.position());
+      retVal = false;
+      break;
     }
-    uint32_t  lineID;
-    int l = _sysLog.readBytesUntil('\n', globalBuff, _recLength);
-#ifdef _DODEBUG
+    if (_sysLog.write((uint8_t*)(_batchBuff + (r * (_recLength +1))), bytes) != bytes)
+    {
+      printf("ESPSL(%d)::flushLog(): ERROR!! writing [%d] records failed\r\n", __LINE__, run);
+      retVal = false;
+    }
+    countFlashWrite(offset, bytes);
+    r += run;
+  }
+  if (r < _batchCount)
+  {
+    printf("ESPSL(%d)::flushLog(): [%d] held records (lineID %d ..) dropped\r\n", __LINE__
+                                                                                , (_batchCount - r)
+                                                                                , (firstID + r));
+  }
+  _sysLog.flush();
+  _statFlashUs += (micros() - started);
+  _statFlushes++;
+  _statPages++;       //-- SPIFFS also rewrites the object index page
+  _wearWinPages++;
+  _batchCount = 0;
+  keepBatch();
+  adaptFlushPolicy();
+  _UNLOCKFILE();
+
+  return retVal;
+
+} // flushLog()
+
+
+//-------------------------------------------------------------------------------------
+//-- count the flash pages programmed for writing bytes @offset
+void ESPSL::countFlashWrite(uint32_t offset, uint32_t bytes) 
+{
+  uint32_t pages = ((offset + bytes -1) / _fsPageSize) - (offset / _fsPageSize) +1;
+
+  _statBytes    += bytes;
+  _statPages    += pages;
+  _wearWinPages += pages;
+
+} // countFlashWrite()
+
+
+//-------------------------------------------------------------------------------------
+void ESPSL::freeBatch() 
+{
+#if defined(ESP32)
+  if (_batchBuff != _rtcBatch.records) { free(_batchBuff); }
+#else
+  free(_batchBuff);
+#endif
+  _batchBuff = NULL;
+  _batchSize = 0;
+
+} // freeBatch()
+
+
+//-------------------------------------------------------------------------------------
+//-- ESP32: describe the records in RTC memory, so begin() can take them back
+void ESPSL::keepBatch() 
+{
+#if defined(ESP32)
+  if ((_batchBuff == NULL) || (_batchBuff != _rtcBatch.records)) { return; }
+  _rtcBatch.firstID   = _lastUsedLineID - _batchCount +1;
+  _rtcBatch.recLength = _recLength;
+  _rtcBatch.count     = _batchCount;
+  _rtcBatch.magic     = _RTCMAGIC;
+  _rtcBatch.check     = (_RTCMAGIC ^ _rtcBatch.firstID ^ _rtcBatch.recLength ^ _rtcBatch.count);
+#endif
+
+} // keepBatch()
+
+
+//-------------------------------------------------------------------------------------
+//-- records that fit in _sleepBytes
+uint16_t ESPSL::sleepBatchSize() 
+{
+  uint32_t recSize = ((_recLength > 0) ? _recLength : (_MAXLINEWIDTH + _KEYLEN)) +1;
+  uint32_t records = _sleepBytes / recSize;
+
+#if defined(ESP32)
+  if (records > (_RTCBATCHBYTES / recSize)) { records = (_RTCBATCHBYTES / recSize); }
+#endif
+  if (records > _MAXSLEEPBATCH) { records = _MAXSLEEPBATCH; }
+  if (records < 1)              { records = 1; }
+#ifdef _LOWMEMORY
+  records = 1;      //-- no RAM for a batch buffer
+#endif
+  return records;
+
+} // sleepBatchSize()
+
+
+//-------------------------------------------------------------------------------------
+//-- widen (or narrow) batching so the wear rate stays within _wearBudget
+void ESPSL::adaptFlushPolicy() 
+{
+  uint32_t  elapsed = millis() - _wearWinStart;
+  float     winRate;
+
+  if ((_wearBudget <= 0.0) || (elapsed < _WEARWINDOW)) { return; }
+
+  winRate = ((float)_wearWinPages * _fsPageSize / _fsBlockSize) * (86400000.0 / elapsed);
+#ifdef _LOWMEMORY
+  if (false)        //-- no RAM for a batch buffer, only the estimate is kept
+#else
+  if ((winRate > _wearBudget) && (_batchMax < _MAXBATCH))
+#endif
+  {
+    //-- records are never held longer than _MAXHOLDMS (unless setFlushPolicy() asked for it)
+    _batchMax   = ((_batchMax *2) > _MAXBATCH) ? _MAXBATCH : (_batchMax *2);
+    _flushDelay = ((_flushDelay == 0) || ((_flushDelay *2) > _MAXHOLDMS)) ? _MAXHOLDMS : (_flushDelay *2);
+    if (_flushDelay < _flushDelayMin) { _flushDelay = _flushDelayMin; }
+  }
+  else if ((winRate < (_wearBudget /2)) && (_batchMax > _batchMin))
+  {
+    _batchMax   = ((_batchMax /2) < _batchMin) ? _batchMin : (_batchMax /2);
+    _flushDelay = ((_flushDelay /2) < _flushDelayMin) ? _flushDelayMin : (_flushDelay /2);
+    if (_batchMax == _batchMin) { _flushDelay = _flushDelayMin; }
+  }
+#ifdef _DODEBUG
+  if (_Debug(2)) printf("ESPSL(%d)::adaptFlushPolicy(): [%d.%02d] erases/day -> batch[%d], delay[%d]ms\r\n"
+                                                      , __LINE__
+                                                      , (int)winRate, ((int)(winRate *100) % 100)
+                                                      , _batchMax, _flushDelay);
+#endif
+  _wearWinStart = millis();
+  _wearWinPages = 0;
+
+} // adaptFlushPolicy()
+
+
+//-------------------------------------------------------------------------------------
+//-- returns true if logLine repeats the previous line (of the same recType, so an 
+//-- error is never folded into an info line) and must not be written
+boolean ESPSL::isDuplicate(const char* logLine, char recType) 
+{
+  const char *key = logLine;
+  uint32_t    hash = 2166136261UL;    //-- FNV-1a
+
+  if ((_dedupMode == ESPSL_DEDUP_FORMAT) && (_dedupFmt != NULL)) { key = _dedupFmt; }
+  hash ^= (uint8_t)recType;
+  hash *= 16777619UL;
+  for(; *key; key++)
+  {
+    hash ^= (uint8_t)*key;
+    hash *= 16777619UL;
+  }
+
+  if (_dedupValid && (hash == _dedupHash))
+  {
+    if (_dedupCount == 0) { _dedupSince = millis(); }
+    _dedupCount++;
+#ifdef _DODEBUG
+    if (_Debug(4)) printf("ESPSL(%d)::isDuplicate(): repeated [%d] times\r\n", __LINE__, _dedupCount);
+#endif
+    if ((millis() - _dedupSince) >= _dedupTimeout) { commitRepeats(); }
+    return true;
+  }
+
+  commitRepeats();
+  _dedupHash  = hash;
+  _dedupValid = true;
+
+  return false;
+
+} // isDuplicate()
+
+
+//-------------------------------------------------------------------------------------
+//-- write the pending repeat counter (if any) to the log
+void ESPSL::commitRepeats() 
+{
+  char repeatBuff[_MINLINEWIDTH];
+
+  if (_dedupCount == 0) { return; }
+
+  _LOCKFILE();
+  snprintf(repeatBuff, sizeof(repeatBuff), "last message repeated %u times", _dedupCount);
+  _dedupCount = 0;
+  writeRecord(repeatBuff);
+  _UNLOCKFILE();
+
+} // commitRepeats()
+
+
+//-------------------------------------------------------------------------------------
+//-- formats into msgBuff(), write() takes it from there
+boolean ESPSL::writef(const char *fmt, ...) 
+{
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::writef(%s)..\r\n", __LINE__, fmt);
+#endif
+
+  _LOCKFILE();
+  va_list args;
+  va_start (args, fmt);
+  vsnprintf (msgBuff(), msgBuffLen(), fmt, args);
+  va_end (args);
+
+  bool retVal = writeFormatted(fmt, msgBuff());
+  _UNLOCKFILE();
+
+  return retVal;
+
+} // writef()
+
+
+//-------------------------------------------------------------------------------------
+//-- write a line formatted by writeT()
+boolean ESPSL::writeFormatted(const char *fmt, const char *logLine, char recType) 
+{
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::writeFormatted(%s)..\r\n", __LINE__, fmt);
+#endif
+
+  _dedupFmt = fmt;
+  bool retVal = writeLine(logLine, recType);
+  _dedupFmt = NULL;
+
+  return retVal;
+
+} // writeFormatted()
+
+
+//-------------------------------------------------------------------------------------
+//-- dbg followed by the formatted text, both in msgBuff() (dbg may be globalBuff,
+//-- as returned by buildD())
+boolean ESPSL::writeDbg(const char *dbg, const char *fmt, ...) 
+{
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::writeDbg(%s, %s)..\r\n", __LINE__, dbg, fmt);
+#endif
+
+  int dbgLen = strlen(dbg);
+
+  _LOCKFILE();
+  char *buff = msgBuff();
+  if (dbgLen > msgLength()) { dbgLen = msgLength(); }
+  memmove(buff, dbg, dbgLen);
+  buff[dbgLen] = '\0';
+  
+  //-- the formatted text is cut off at msgLength()
+  if (dbgLen < msgLength())
+  {
+    va_list args;
+    va_start (args, fmt);
+    vsnprintf ((buff + dbgLen), ((msgLength() +1) - dbgLen), fmt, args);
+    va_end (args);
+  }
+  
+  //printf("ESPSL(%d)::writeDbg(): dbgStr[%s]..\r\n", __LINE__, buff);
+  bool retVal = writeFormatted(fmt, buff);
+  _UNLOCKFILE();
+  
+  return retVal;
+
+} // writeDbg()
+
+
+//-------------------------------------------------------------------------------------
+//-- write a line with severity level (ESPSL_LEVEL_DEBUG .. ESPSL_LEVEL_ERROR)
+boolean ESPSL::writeLevel(uint8_t level, const char *logLine) 
+{
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::writeLevel(%d, %s)..\r\n", __LINE__, level, logLine);
+#endif
+
+  return writeLine(logLine, ESPSL_rec::recTypeOf(level));
+
+} // writeLevel()
+
+
+//-------------------------------------------------------------------------------------
+boolean ESPSL::writefLevel(uint8_t level, const char *fmt, ...) 
+{
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::writefLevel(%d, %s)..\r\n", __LINE__, level, fmt);
+#endif
+
+  _LOCKFILE();
+  va_list args;
+  va_start (args, fmt);
+  vsnprintf (msgBuff(), msgBuffLen(), fmt, args);
+  va_end (args);
+
+  bool retVal = writeFormatted(fmt, msgBuff(), ESPSL_rec::recTypeOf(level));
+  _UNLOCKFILE();
+
+  return retVal;
+
+} // writefLevel()
+
+
+//-------------------------------------------------------------------------------------
+char *ESPSL::buildD(const char *fmt, ...) 
+{
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::buildD(%s)..\r\n", __LINE__, fmt);
+#endif
+  memset(globalBuff, 0, sizeof(globalBuff));
+  
+  va_list args;
+  va_start (args, fmt);
+  vsnprintf (globalBuff, (_MAXLINEWIDTH), fmt, args);
+  va_end (args);
+
+  //-- remove control chars
+  for(int i=0; (globalBuff[i]!=0); i++)
+  {
+    if ((globalBuff[i] < ' ') || (globalBuff[i] > '~')) { globalBuff[i] = '^'; }
+  }
+
+  return globalBuff;
+  
+} // buildD()
+
+
+//-------------------------------------------------------------------------------------
+//-- set pointer to startLine
+void ESPSL::startReading() 
+{
+  _readNext         = getOldestLineID();
+  _readNextEnd      = _lastUsedLineID +1;
+  _readPrevious     = _lastUsedLineID;
+  _readPreviousEnd  = _readNext -1;
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::startReading()..next[%d] to [%d]\r\n", __LINE__, _readNext, _readNextEnd);
+  if (_Debug(1)) printf("ESPSL(%d)::startReading()..prev[%d] to [%d]\r\n", __LINE__, _readPrevious, _readPreviousEnd);
+#endif
+
+} // startReading()
+
+//-------------------------------------------------------------------------------------
+//-- returns the next (newer) line, from the oldest line up to the last line
+//-- (at the time of startReading()) in lineID order
+bool ESPSL::readNextLine(char *lineOut, int lineOutLen)
+{
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::readNextLine(%d)\r\n", __LINE__, _readNext);
+#endif
+
+  _readNext = nextLineID(_readNext);
+  while (_readNext < _readNextEnd)
+  {
+    switch(readLine(_readNext, lineOut, lineOutLen))
+    {
+      case ESPSL_READ_OK:           
+              _readNext++;
+              return true;
+      case ESPSL_READ_OVERWRITTEN:  
+#ifdef _DODEBUG
+              if (_Debug(4)) printf("ESPSL(%d)::readNextLine(): SKIP[%d]\r\n", __LINE__, _readNext);
+#endif
+              _readNext = nextLineID(_readNext +1);
+              break;
+      case ESPSL_READ_CONTINUED:
+              //-- part of the line before it
+              _readNext++;
+              break;
+      default:
+              return false;
+    }
+  }
+
+  return false;
+
+} //  readNextLine()
+
+//-------------------------------------------------------------------------------------
+//-- returns the previous (older) line, from the last line down to the oldest line
+bool ESPSL::readPreviousLine(char *lineOut, int lineOutLen)
+{
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::readPreviousLine(%d/%d)\r\n", __LINE__, _readPrevious, _readPreviousEnd);
+#endif
+
+  _readPrevious = prevLineID(_readPrevious);
+  while ((_readPrevious > 0) && (_readPrevious > _readPreviousEnd))
+  {
+    switch(readLine(_readPrevious, lineOut, lineOutLen))
+    {
+      case ESPSL_READ_OK:           
+              _readPrevious--;
+              return true;
+      case ESPSL_READ_OVERWRITTEN:  
+#ifdef _DODEBUG
+              if (_Debug(4)) printf("ESPSL(%d)::readPreviousLine(): SKIP[%d]\r\n", __LINE__, _readPrevious);
+#endif
+              _readPrevious = prevLineID(_readPrevious -1);
+              break;
+      case ESPSL_READ_CONTINUED:
+              _readPrevious--;
+              break;
+      default:
+              return false;
+    }
+  }
+
+  return false;
+
+} //  readPreviousLine()
+
+//-------------------------------------------------------------------------------------
+//-- read the line with ID lineID (O(1), the slot follows from the ID, or from the
+//-- (small) list of reserved slots)
+int8_t ESPSL::readLine(int32_t lineID, char *lineOut, int lineOutLen)
+{
+  int32_t   recID;
+  uint32_t  seekToLine;
+  
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::readLine(%d)\r\n", __LINE__, lineID);
+#endif
+
+  if (lineID > _lastUsedLineID) 
+  {
+    lineOut[0] = '\0';
+    return ESPSL_READ_NOTWRITTEN;
+  }
+  if (inArchive(lineID))        { return readArchive(lineID, lineOut, lineOutLen); }
+  seekToLine = slotOf(lineID);
+  if (seekToLine == 0)  
+  {
+    lineOut[0] = '\0';
+    return ESPSL_READ_OVERWRITTEN;
+  }
+
+  if (!readRecord(seekToLine, &recID, lineOut, lineOutLen))
+  {
+    lineOut[0] = '\0';
+    return ESPSL_READ_ERROR;
+  }
+  if ((recID != lineID) && (seekToLine <= (uint32_t)_numLines))
+  {
+    //-- never made it to its ring slot (a dropped batch), there might be a reserved copy
+    for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
+    {
+      if ((_resIDs[r] == lineID) && readRecord((_numLines +1 +r), &recID, lineOut, lineOutLen)) { break; }
+    }
+  }
+  if (recID != lineID)  
+  {
+    lineOut[0] = '\0';
+    return ESPSL_READ_OVERWRITTEN;
+  }
+  if (_readType == _RECCONT)  
+  {
+    lineOut[0] = '\0';
+    return ESPSL_READ_CONTINUED;
+  }
+
+  return ESPSL_READ_OK;
+
+} //  readLine()
+
+//-------------------------------------------------------------------------------------
+//-- hand lines startID .. startID+count-1 that are still in the log to callback()
+//-- stops early if callback() returns false
+int16_t ESPSL::readPage(int32_t startID, int16_t count, ESPSL_lineCallback callback)
+{
+  int32_t   lineID;
+  int16_t   lines = 0;
+  char      lineLocal[_MAXLINEWIDTH + _KEYLEN];
+  int       lineLen = sizeof(lineLocal);
+  char     *lineIn  = takeLineBuff(lineLocal, &lineLen);
+  
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::readPage(%d, %d)\r\n", __LINE__, startID, count);
+#endif
+
+  if (startID < getOldestLineID()) 
+  {
+    count  -= (getOldestLineID() - startID);
+    startID = getOldestLineID();
+  }
+  for(lineID = startID; (lineID < (startID + count)); lineID++)
+  {
+    int8_t readStatus = readLine(lineID, lineIn, lineLen);
+    if (readStatus == ESPSL_READ_NOTWRITTEN)  { break; }
+    if (readStatus != ESPSL_READ_OK)          { continue; }
+    lines++;
+    if (!callback(lineID, lineIn))            { break; }
+  }
+  giveLineBuff(lineIn, lineLocal);
+
+  return lines;
+
+} //  readPage()
+
+//-------------------------------------------------------------------------------------
+//-- read record in slot seekToLine, returns the lineID and the (trimmed) text
+//-- (followed by the text of its continuation records) or, with asJson, the line 
+//-- as a JSON object
+boolean ESPSL::readRecord(uint32_t seekToLine, int32_t *lineID, char *lineOut, int lineOutLen
+                        , boolean asJson)
+{
+  uint32_t  offset = (seekToLine * (_recLength +1));
+  int32_t   contID;
+  int       textEnd;
+  char     *pChar;
+  char      recType;
+  boolean   more;
+
+  _LOCKFILE();
+  char     *buff = msgBuff();
+  int l = readSlot(seekToLine, buff);
+  if (l < 0) 
+  {
+    printf("ESPSL(%d)::readRecord(): seek to position [%d/%04d] failed (now @%d)\r\n", __LINE__
+                                                                                     , seekToLine
+                                                                                     , offset
+                                                                                     , _sysLog.position());
+    _UNLOCKFILE();
+    return false;
+  }
+  buff[l] = '\0';
+
+  //-- "%010d|<text>"
+  pChar = (char*)ESPSL_rec::parseKey(buff, lineID, &recType);
+  if (pChar == NULL) { pChar = buff + l; }   //-- not a record, no text
+  _readLevel = ESPSL_rec::levelOf(recType);
+  _readType  = recType;
+
+  //-- the continuation records are read behind the text (their key is moved out)
+  more    = (l == _recLength) && (buff[_recLength -1] == _RECMORE) && (seekToLine <= (uint32_t)_numLines);
+  textEnd = (_recLength -1);
+  for (contID = (*lineID +1); more && (contID <= _lastUsedLineID) 
+                            && ((textEnd + _recLength) < msgBuffLen()); contID++)
+  {
+    int32_t recID;
+    char    contType;
+
+    more = false;
+    l = readSlot(((contID % _numLines) +1), (buff + textEnd));
+    if (l < 0) { break; }
+    buff[textEnd + l] = '\0';
+    if (   (ESPSL_rec::parseKey((buff + textEnd), &recID, &contType) == NULL)
+        || (recID != contID) || (contType != _RECCONT) || (l != _recLength)) { break; }
+    more = (buff[textEnd + _recLength -1] == _RECMORE);
+    memmove((buff + textEnd), (buff + textEnd + _KEYLEN), (_lineWidth -1));
+    textEnd += (_lineWidth -1);
+  }
+  buff[textEnd] = '\0';
+
+  rtrim(pChar);
+  if (recType == _RECEVENT)
+  {
+    ESPSL_rec::renderEvent(pChar, *lineID, lineOut, lineOutLen, asJson);
+  }
+  else if (asJson)
+  {
+    ESPSL_rec::renderJsonText(pChar, *lineID, _readLevel, lineOut, lineOutLen);
+  }
+  else
+  {
+    strlcpy(lineOut, pChar, lineOutLen);
+  }
+  _UNLOCKFILE();
+
+  return true;
+
+} //  readRecord()
+
+//-------------------------------------------------------------------------------------
+//-- copy the record in slot seekToLine to recOut (without '\n'), from RAM if the slot
+//-- is written by a record that is still held in the batch, so reading does not need
+//-- a flushLog(). Returns the number of bytes (-1 if the seek failed)
+int ESPSL::readSlot(uint32_t seekToLine, char *recOut)
+{
+  int32_t   firstID, lineID;
+
+  if (   (_batchCount > 0) && (seekToLine >= 1) && (seekToLine <= (uint32_t)_numLines)
+      && (_lastUsedLineID >= (int32_t)(seekToLine -1)) )
+  {
+    //-- the newest lineID that goes to this slot
+    firstID = _lastUsedLineID - _batchCount +1;
+    lineID  = _lastUsedLineID - ((_lastUsedLineID - (int32_t)(seekToLine -1)) % _numLines);
+    if (lineID >= firstID)
+    {
+      memcpy(recOut, (_batchBuff + ((lineID - firstID) * (_recLength +1))), _recLength);
+      return _recLength;
+    }
+  }
+  if (!_sysLog.seek((seekToLine * (_recLength +1)), SeekSet)) { return -1; }
+  return _sysLog.readBytesUntil('\n', recOut, _recLength);
+
+} //  readSlot()
+
+
+//-------------------------------------------------------------------------------------
+//-- export lines fromID .. last as JSON lines (one object per line) to out
+int16_t ESPSL::exportJson(Print *out, int32_t fromID)
+{
+  int32_t   lineID, recID;
+  int16_t   lines = 0;
+  char      jsonLocal[(_MAXLINEWIDTH *2) + _KEYLEN];
+  int       jsonLen  = sizeof(jsonLocal);
+  char     *jsonLine = takeLineBuff(jsonLocal, &jsonLen);
+
+  for (lineID = nextLineID(fromID); lineID <= _lastUsedLineID; lineID = nextLineID(lineID +1))
+  {
+    if (inArchive(lineID))
+    {
+      if (readArchive(lineID, jsonLine, jsonLen, true) != ESPSL_READ_OK) { continue; }
+      out->println(jsonLine);
+      lines++;
+      continue;
+    }
+    if (slotOf(lineID) == 0) { continue; }
+    if (!readRecord(slotOf(lineID), &recID, jsonLine, jsonLen, true)) { break; }
+    if (recID != lineID)  { continue; }   //-- overwritten meanwhile
+    if (_readType == _RECCONT) { continue; } //-- exported with its first record
+    out->println(jsonLine);
+    lines++;
+  }
+  giveLineBuff(jsonLine, jsonLocal);
+
+  return lines;
+
+} //  exportJson()
+
+
+
+
+//===========================================================================================
+//-- Search index: a Bloom filter of the words in every block of _IDXBLOCK slots, saved
+//-- in _idxFile ([magic, numLines, _IDXBLOCK, _IDXBYTES] followed by the filters).
+//-- The filter of the block the writer is in is kept in RAM (the lines written in this
+//-- round) next to the filter of that block as it was saved (the older lines), it is 
+//-- saved when the writer moves on to the next block.
+//===========================================================================================
+static boolean isWordChar(char c)
+{
+  return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'z')) 
+      || ((c >= 'A') && (c <= 'Z')) || (c == '_');
+
+} // isWordChar()
+
+//-- next word in *text, returns its length (0 at the end of text)
+static int nextWord(const char **text, const char **start)
+{
+  while ((**text != '\0') && !isWordChar(**text)) { (*text)++; }
+  *start = *text;
+  while ((**text != '\0') &&  isWordChar(**text)) { (*text)++; }
+  return (*text - *start);
+
+} // nextWord()
+
+//-- FNV-1a of the lower case word
+static uint32_t wordHash(const char *word, int len)
+{
+  uint32_t hash = 2166136261UL;
+
+  for (int i=0; i < len; i++)
+  {
+    char c = word[i];
+    if ((c >= 'A') && (c <= 'Z')) { c += ('a' - 'A'); }
+    hash = (hash ^ (uint8_t)c) * 16777619UL;
+  }
+  return hash;
+
+} // wordHash()
+
+static void bloomAdd(uint8_t *bloom, uint32_t hash)
+{
+  uint32_t step = ((hash >> 17) | (hash << 15)) | 1;
+
+  for (int i=0; i < _IDXHASHES; i++, hash += step)
+  {
+    bloom[(hash % (_IDXBYTES * 8)) / 8] |= (1 << (hash % 8));
+  }
+
+} // bloomAdd()
+
+static boolean bloomTest(const uint8_t *bloom, uint32_t hash)
+{
+  uint32_t step = ((hash >> 17) | (hash << 15)) | 1;
+
+  for (int i=0; i < _IDXHASHES; i++, hash += step)
+  {
+    if ((bloom[(hash % (_IDXBYTES * 8)) / 8] & (1 << (hash % 8))) == 0) { return false; }
+  }
+  return true;
+
+} // bloomTest()
+
+//-- add the words of text to bloom (for events the type char in front of a key is skipped)
+static void indexText(uint8_t *bloom, const char *text, char recType)
+{
+  const char *begin = text;
+  const char *start;
+  int         len;
+
+  while ((len = nextWord(&text, &start)) > 0)
+  {
+    if ((recType == _RECEVENT) && (start > begin) && (*(start -1) == '`'))
+    {
+      start++;
+      len--;
+    }
+    if (len > 0) { bloomAdd(bloom, wordHash(start, len)); }
+  }
+
+} // indexText()
+
+//-- does text contain word (not case sensitive)?
+static boolean hasWord(const char *text, const char *word)
+{
+  const char *start;
+  int         len, wordLen = strlen(word);
+
+  while ((len = nextWord(&text, &start)) > 0)
+  {
+    if ((len == wordLen) && (strncasecmp(start, word, len) == 0)) { return true; }
+  }
+  return false;
+
+} // hasWord()
+
+
+//-------------------------------------------------------------------------------------
+//-- keep a search index next to the logfile
+void ESPSL::setSearchIndex(boolean enable) 
+{
+  _idxEnabled = enable;
+  if (!enable)
+  {
+    free(_idxBloom);
+    _idxBloom = NULL;
+  }
+
+} // setSearchIndex()
+
+
+//-------------------------------------------------------------------------------------
+//-- read _idxFile, (re)build it from the logfile if it does not match
+boolean ESPSL::loadIndex() 
+{
+  File      idxFile;
+  int32_t   header[4] = { 0, 0, 0, 0 };
+  int32_t   blocks    = (_numLines + _IDXBLOCK -1) / _IDXBLOCK;
+  uint32_t  nextSlot, blockStart;
+
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::loadIndex()..\r\n", __LINE__);
+#endif
+  free(_idxBloom);
+  _idxBloom = (uint8_t*)malloc(3 * _IDXBYTES);
+  if (_idxBloom == NULL)
+  {
+    printf("ESPSL(%d)::loadIndex(): no memory for the search index\r\n", __LINE__);
+    return false;
+  }
+  memset(_idxBloom, 0, (3 * _IDXBYTES));
+  nextSlot   = ((_lastUsedLineID +1) % _numLines);
+  _idxBlock  = (nextSlot / _IDXBLOCK);
+  blockStart = (_idxBlock * _IDXBLOCK);
+
+  idxFile = SPIFFS.open(_idxFile, "r");
+  if (idxFile) 
+  {
+    idxFile.read((uint8_t*)header, sizeof(header));
+    if (idxFile.size() != (sizeof(header) + (blocks * _IDXBYTES))) { header[0] = 0; }
+    idxFile.close();
+  }
+  if (   (header[0] != _IDXMAGIC) || (header[1] != _numLines) 
+      || (header[2] != _IDXBLOCK) || (header[3] != _IDXBYTES) )
+  {
+    printf("ESPSL(%d)::loadIndex(): build search index [%s]\r\n", __LINE__, _idxFile);
+    idxFile = SPIFFS.open(_idxFile, "w");
+    if (!idxFile) 
+    {
+      printf("ESPSL(%d)::loadIndex(): Some error opening [%s]\r\n", __LINE__, _idxFile);
+      free(_idxBloom);
+      _idxBloom = NULL;
+      return false;
+    }
+    header[0] = _IDXMAGIC;
+    header[1] = _numLines;
+    header[2] = _IDXBLOCK;
+    header[3] = _IDXBYTES;
+    idxFile.write((const uint8_t*)header, sizeof(header));
+    for (int32_t b = 0; b < blocks; b++)
+    {
+      yield();
+      memset(_idxBloom, 0, _IDXBYTES);
+      //-- a new logfile has no words
+      if (_lastUsedLineID > 0) { indexSlots(_idxBloom, (b * _IDXBLOCK), ((b +1) * _IDXBLOCK)); }
+      idxFile.write(_idxBloom, _IDXBYTES);
+    }
+    idxFile.close();
+  }
+  else if ((nextSlot == blockStart) && (_lastUsedLineID > 0))
+  {
+    //-- the writer just finished the block before, it might not have been saved
+    int32_t prevBlock = ((_idxBlock + blocks -1) % blocks);
+    memset(_idxBloom, 0, _IDXBYTES);
+    indexSlots(_idxBloom, (prevBlock * _IDXBLOCK), ((prevBlock +1) * _IDXBLOCK));
+    saveIndexBlock(prevBlock, _idxBloom);
+  }
+
+  //-- the writer's block: new lines in _idxBloom, the block as saved after that
+  memset(_idxBloom, 0, _IDXBYTES);
+  indexSlots(_idxBloom, blockStart, nextSlot);
+  idxFile = SPIFFS.open(_idxFile, "r");
+  readIndexBlock(idxFile, _idxBlock, (_idxBloom + _IDXBYTES));
+  idxFile.close();
+  
+  //-- and the reserved region
+  for (uint16_t r = 0; (_resIDs != NULL) && (r < _numReserved); r++)
+  {
+    int32_t lineID;
+    char    lineIn[_recLength];
+    if (readRecord((_numLines +1 +r), &lineID, lineIn, _recLength) && (lineID > 0))
+    {
+      indexText((_idxBloom + (2 * _IDXBYTES)), lineIn, _RECTEXT);
+    }
+  }
+
+  return true;
+
+} // loadIndex()
+
+
+//-------------------------------------------------------------------------------------
+//-- add the words of the (text) of the records in slots fromSlot .. toSlot-1 to bloom
+void ESPSL::indexSlots(uint8_t *bloom, uint32_t fromSlot, uint32_t toSlot) 
+{
+  int32_t   lineID;
+  char      lineLocal[_MAXLINEWIDTH + _KEYLEN];
+  int       lineLen = sizeof(lineLocal);
+  char     *lineIn  = takeLineBuff(lineLocal, &lineLen);
+
+  if (toSlot > (uint32_t)_numLines) { toSlot = _numLines; }
+  for (uint32_t slot = fromSlot; slot < toSlot; slot++)
+  {
+    if (!readRecord((slot +1), &lineID, lineIn, lineLen)) { break; }
+    if ((lineID > 0) && (_readType != _RECCONT)) { indexText(bloom, lineIn, _RECTEXT); }
+  }
+  giveLineBuff(lineIn, lineLocal);
+
+} // indexSlots()
+
+
+//-------------------------------------------------------------------------------------
+//-- add a record written to slot to the index
+void ESPSL::indexRecord(uint32_t slot, const char *text, char recType) 
+{
+  int32_t block = (slot / _IDXBLOCK);
+  File    idxFile;
+
+  if (block != _idxBlock)
+  {
+    //-- the writer moves on to the next block
+    saveIndexBlock(_idxBlock, _idxBloom);
+    idxFile = SPIFFS.open(_idxFile, "r");
+    readIndexBlock(idxFile, block, (_idxBloom + _IDXBYTES));
+    idxFile.close();
+    memset(_idxBloom, 0, _IDXBYTES);
+    _idxBlock = block;
+  }
+  indexText(_idxBloom, text, recType);
+
+} // indexRecord()
+
+
+//-------------------------------------------------------------------------------------
+//-- a block that can not be read matches every word
+void ESPSL::readIndexBlock(File &idxFile, int32_t block, uint8_t *bloom) 
+{
+  if (   !idxFile || !idxFile.seek((16 + (block * _IDXBYTES)), SeekSet)
+      || (idxFile.read(bloom, _IDXBYTES) != _IDXBYTES) )
+  {
+    memset(bloom, 0xFF, _IDXBYTES);
+  }
+
+} // readIndexBlock()
+
+
+//-------------------------------------------------------------------------------------
+void ESPSL::saveIndexBlock(int32_t block, const uint8_t *bloom) 
+{
+  File      idxFile;
+  uint32_t  offset = (16 + (block * _IDXBYTES));
+
+  idxFile = SPIFFS.open(_idxFile, "r+");
+  if (!idxFile || !idxFile.seek(offset, SeekSet)) 
+  {
+    printf("ESPSL(%d)::saveIndexBlock(): Some error writing [%s]\r\n", __LINE__, _idxFile);
+    return;
+  }
+  idxFile.write(bloom, _IDXBYTES);
+  idxFile.close();
+  countFlashWrite(offset, _IDXBYTES);
+
+} // saveIndexBlock()
+
+
+//-------------------------------------------------------------------------------------
+//-- might block contain a word with this hash (without an index: always)
+boolean ESPSL::mayContain(File &idxFile, int32_t block, uint32_t hash) 
+{
+  uint8_t   bloom[_IDXBYTES];
+  boolean   found;
+
+  if (_idxBloom == NULL) { return true; }
+
+  _LOCKFILE();
+  if (block == _idxBlock)
+  {
+    found = bloomTest(_idxBloom, hash) || bloomTest((_idxBloom + _IDXBYTES), hash);
+    _UNLOCKFILE();
+    return found;
+  }
+  _UNLOCKFILE();
+  readIndexBlock(idxFile, block, bloom);
+  return bloomTest(bloom, hash);
+
+} // mayContain()
+
+
+//-------------------------------------------------------------------------------------
+//-- hand the lines (fromID .. last) that contain word to callback(), only blocks
+//-- of which the index says they might contain word are read
+//-- stops early if callback() returns false
+int16_t ESPSL::search(const char *word, ESPSL_lineCallback callback, int32_t fromID) 
+{
+  uint32_t  hash = wordHash(word, strlen(word));
+  int32_t   lineID, ringOldest, slot, blockEnd;
+  int16_t   lines = 0;
+  char      lineLocal[_MAXLINEWIDTH + _KEYLEN];
+  int       lineLen = sizeof(lineLocal);
+  char     *lineIn  = takeLineBuff(lineLocal, &lineLen);
+  File      idxFile;
+
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::search(%s, %d)\r\n", __LINE__, word, fromID);
+#endif
+  ringOldest = (_lastUsedLineID < _numLines) ? 1 : (_lastUsedLineID - _numLines +1);
+
+  //-- lines older than the ring can only be in the reserved region
+  if ((_idxBloom == NULL) || bloomTest((_idxBloom + (2 * _IDXBYTES)), hash))
+  {
+    for (lineID = nextLineID(fromID, false); lineID < ringOldest; lineID = nextLineID((lineID +1), false))
+    {
+      if (readLine(lineID, lineIn, lineLen) != ESPSL_READ_OK)     { continue; }
+      if (!hasWord(lineIn, word))                                 { continue; }
+      lines++;
+      if (!callback(lineID, lineIn))
+      {
+        giveLineBuff(lineIn, lineLocal);
+        return lines;
+      }
+    }
+  }
+
+  if (fromID < ringOldest) { fromID = ringOldest; }
+  if (_idxBloom != NULL)   { idxFile = SPIFFS.open(_idxFile, "r"); }
+  for (lineID = fromID; lineID <= _lastUsedLineID; )
+  {
+    slot     = (lineID % _numLines);
+    blockEnd = (((slot / _IDXBLOCK) +1) * _IDXBLOCK);
+    if (blockEnd > _numLines) { blockEnd = _numLines; }
+    if (!mayContain(idxFile, (slot / _IDXBLOCK), hash))
+    {
+      lineID += (blockEnd - slot);
+      continue;
+    }
+    for (; (slot < blockEnd) && (lineID <= _lastUsedLineID); slot++, lineID++)
+    {
+      if (readLine(lineID, lineIn, lineLen) != ESPSL_READ_OK)     { continue; }
+      if (!hasWord(lineIn, word))                                 { continue; }
+      lines++;
+      if (!callback(lineID, lineIn))                              { lineID = _lastUsedLineID +1; break; }
+    }
+  }
+  if (idxFile) { idxFile.close(); }
+  giveLineBuff(lineIn, lineLocal);
+
+  return lines;
+
+} // search()
+
+
+//===========================================================================================
+//-- ESPSL_Event: build a structured log line
+//===========================================================================================
+ESPSL_Event::ESPSL_Event(ESPSL &sysLog, const char *eventName) 
+{ 
+  _sysLog     = &sysLog;
+  _len        = 0;
+  _maxLen     = _sysLog->_lineWidth -2;   //-- keep room for the closing '`'
+  if (_maxLen > _MAXLINEWIDTH)  { _maxLen = _MAXLINEWIDTH; }
+  _fieldStart = 0;
+  _rec[0]     = '\0';
+  addName(0, eventName);
+
+} // ESPSL_Event()
+
+//-------------------------------------------------------------------------------------
+void ESPSL_Event::addChar(char c) 
+{
+  if (_len < _maxLen) 
+  {
+    _rec[_len++] = c;
+    _rec[_len]   = '\0';
+  }
+  else _len = _maxLen +1;   //-- overflow, endField() drops this field
+
+} // addChar()
+
+//-------------------------------------------------------------------------------------
+//-- field separator, type and name (only printable chars that do not clash)
+void ESPSL_Event::addName(char type, const char *name) 
+{
+  _fieldStart = _len;
+  if (type != 0)
+  {
+    addChar('`');
+    addChar(type);
+  }
+  for(; *name; name++)
+  {
+    if ((*name <= ' ') || (*name > '~') || (*name == '`') || (*name == ':') || (*name == '\\')) 
+          addChar('_');
+    else  addChar(*name);
+  }
+  if (type != 0) { addChar(':'); }
+
+} // addName()
+
+//-------------------------------------------------------------------------------------
+//-- value in base64 digits, most significant first (digits 0 -> as few as possible)
+void ESPSL_Event::addNumber(uint32_t value, int8_t digits) 
+{
+  if (digits == 0) 
+  {
+    for(uint32_t v = (value >> 6); v > 0; v >>= 6) { digits++; }
+    digits++;
+  }
+  while (digits-- > 0) { addChar(ESPSL_rec::b64Digits[(value >> (digits * 6)) & 0x3F]); }
+
+} // addNumber()
+
+//-------------------------------------------------------------------------------------
+//-- a field that does not fit is dropped as a whole
+void ESPSL_Event::endField() 
+{
+  if (_len > _maxLen)
+  {
+    _len = _fieldStart;
+    _rec[_len] = '\0';
+  }
+
+} // endField()
+
+//-------------------------------------------------------------------------------------
+ESPSL_Event &ESPSL_Event::add(const char *key, long value) 
+{
+  addName('i', key);
+  addNumber(((uint32_t)value << 1) ^ (uint32_t)((int32_t)value >> 31), 0);   //-- zigzag
+  endField();
+  return *this;
+
+} // add(long)
+
+//-------------------------------------------------------------------------------------
+ESPSL_Event &ESPSL_Event::add(const char *key, int value) 
+{
+  return add(key, (long)value);
+
+} // add(int)
+
+//-------------------------------------------------------------------------------------
+ESPSL_Event &ESPSL_Event::add(const char *key, unsigned int value) 
+{
+  return add(key, (unsigned long)value);
+
+} // add(unsigned int)
+
+//-------------------------------------------------------------------------------------
+//-- a field of its own, values >= 2^31 do not fit the zigzag of add(long)
+ESPSL_Event &ESPSL_Event::add(const char *key, unsigned long value) 
+{
+  addName('u', key);
+  addNumber((uint32_t)value, 0);
+  endField();
+  return *this;
+
+} // add(unsigned long)
+
+//-------------------------------------------------------------------------------------
+ESPSL_Event &ESPSL_Event::add(const char *key, float value) 
+{
+  uint32_t bits;
+
+  memcpy(&bits, &value, sizeof(bits));
+  addName('f', key);
+  addNumber(bits, 6);
+  endField();
+  return *this;
+
+} // add(float)
+
+//-------------------------------------------------------------------------------------
+//-- stored as a float (about 7 significant digits)
+ESPSL_Event &ESPSL_Event::add(const char *key, double value) 
+{
+  return add(key, (float)value);
+
+} // add(double)
+
+//-------------------------------------------------------------------------------------
+ESPSL_Event &ESPSL_Event::add(const char *key, bool value) 
+{
+  addName('b', key);
+  addChar(value ? '1' : '0');
+  endField();
+  return *this;
+
+} // add(bool)
+
+//-------------------------------------------------------------------------------------
+ESPSL_Event &ESPSL_Event::add(const char *key, const char *value) 
+{
+  addName('s', key);
+  for(; *value; value++)
+  {
+    if ((*value == '`') || (*value == '\\')) { addChar('\\'); }
+    if ((*value < ' ') || (*value > '~'))   addChar('^');
+    else                                     addChar(*value);
+  }
+  endField();
+  return *this;
+
+} // add(const char*)
+
+//-------------------------------------------------------------------------------------
+//-- write the event to the log
+boolean ESPSL_Event::write() 
+{
+  _rec[_len] = '`';     //-- protects trailing spaces against rtrim()
+  _rec[_len +1] = '\0';
+  return _sysLog->writeLine(_rec, _RECEVENT);
+
+} // write()
+
+
+//===========================================================================================
+//-- ESPSL_Reader: a read cursor of its own, many can be used at the same time
+//===========================================================================================
+ESPSL_Reader::ESPSL_Reader(ESPSL &sysLog) 
+{ 
+  _sysLog   = &sysLog;
+  _headID   = 0;
+  _nextID   = 1;
+  _prevID   = 0;
+  _lineID   = 0;
+  startCounting();
+
+} // ESPSL_Reader()
+
+//-------------------------------------------------------------------------------------
+//-- take a snapshot of the log, lines written after this are not returned
+void ESPSL_Reader::startReading() 
+{
+  _headID   = _sysLog->getLastLineID();
+  _nextID   = _sysLog->getOldestLineID();
+  _prevID   = _headID;
+  _lineID   = 0;
+  startCounting();
+
+} // startReading()
+
+//-------------------------------------------------------------------------------------
+//-- read only the lines of boot session (0 = this boot, 1 = the boot before ..)
+boolean ESPSL_Reader::startReading(uint8_t session) 
+{
+  startReading();
+  if (_sysLog->getSessionStartID(session) == 0) { return false; }
+
+  _headID   = _sysLog->getSessionEndID(session);
+  _nextID   = _sysLog->getSessionStartID(session);
+  _prevID   = _headID;
+  //-- the lines of the session that are gone already are not skipped lines
+  if (_nextID < _sysLog->getOldestLineID()) { _nextID = _sysLog->getOldestLineID(); }
+  startCounting();
+  return true;
+
+} // startReading()
+
+//-------------------------------------------------------------------------------------
+//-- only lines that could be read at the snapshot and are overwritten after it count
+//-- as skipped: not the gaps before the ring (reserved lines) and not the continuation
+//-- records of a line (see ESPSL::contBefore())
+void ESPSL_Reader::startCounting() 
+{
+  int32_t lastID     = _sysLog->_lastUsedLineID;
+  int32_t ringOldest = (lastID < _sysLog->_numLines) ? 1 : (lastID - _sysLog->_numLines +1);
+  int32_t arcOldest  = _sysLog->archiveOldestID();
+
+  _snapOldest = ringOldest;
+  if ((arcOldest > 0) && (_sysLog->_arcLastID >= (ringOldest -1))) { _snapOldest = arcOldest; }
+  _baseID     = (_nextID > ringOldest) ? _nextID : ringOldest;
+  if (!_sysLog->contBefore(_baseID, &_contLow)) { _contLow = 0; }
+  _highKnown  = _sysLog->contBefore((_headID +1), &_contHigh);
+  _nextKnown  = true;
+  _skipped    = 0;
+  _nextRead   = 0;
+  _prevRead   = 0;
+  _nextCont   = 0;
+  _prevCont   = 0;
+
+} // startCounting()
+
+//-------------------------------------------------------------------------------------
+//-- continuation records written before lineID (from _baseID on), false if not known
+boolean ESPSL_Reader::contBefore(int32_t lineID, uint16_t *count) 
+{
+  if (lineID <= _baseID)         { *count = _contLow;  return true; }
+  if (lineID == (_headID +1))    { *count = _contHigh; return _highKnown; }
+  if ((lineID == _nextID) && _nextKnown) 
+  {
+    *count = (uint16_t)(_contLow + _nextRead + _nextCont);
+    return true;
+  }
+  return _sysLog->contBefore(lineID, count);
+
+} // contBefore()
+
+//-------------------------------------------------------------------------------------
+//-- returns the next (newer) line of the snapshot, overwritten lines are skipped
+bool ESPSL_Reader::readNextLine(char *lineOut, int lineOutLen) 
+{
+  int32_t   nextID, fromID;
+  uint16_t  contNext;
+
+  while (_nextID <= _headID)
+  {
+    switch(_sysLog->readLine(_nextID, lineOut, lineOutLen))
+    {
+      case ESPSL_READ_OK:
+              _lineID = _nextID++;
+              return true;
+      case ESPSL_READ_OVERWRITTEN:
+              //-- the writer passed us, continue with the next line left
+              nextID    = _sysLog->nextLineID(_nextID +1);
+              if (nextID > (_headID +1)) { nextID = (_headID +1); }  //-- not after the snapshot
+              fromID    = (_nextID > _snapOldest) ? _nextID : _snapOldest;
+              if (nextID > fromID) { _skipped += (nextID - fromID); }
+              //-- the continuation records among them (and the ones skipped before)
+              _nextKnown = contBefore(nextID, &contNext);
+              if (_nextKnown) { _nextCont = (uint16_t)(contNext - _contLow - _nextRead); }
+              _nextID   = nextID;
+              break;
+      case ESPSL_READ_CONTINUED:
+              //-- part of the line before it, not a skipped line
+              if (_nextID >= _baseID) { _nextRead++; }
+              _nextID++;
+              break;
+      default:
+              return false;
+    }
+  }
+  return false;
+
+} // readNextLine()
+
+//-------------------------------------------------------------------------------------
+//-- returns the previous (older) line of the snapshot
+bool ESPSL_Reader::readPreviousLine(char *lineOut, int lineOutLen) 
+{
+  int32_t   prevID, downToID;
+  uint16_t  contPrev;
+
+  while ((_prevID >= 1) && (_prevID >= _nextID))
+  {
+    switch(_sysLog->readLine(_prevID, lineOut, lineOutLen))
+    {
+      case ESPSL_READ_OK:
+              _lineID = _prevID--;
+              return true;
+      case ESPSL_READ_OVERWRITTEN:
+              //-- continue with the previous line left
+              prevID    = _sysLog->prevLineID(_prevID -1);
+              if (prevID < _nextID) { prevID = _nextID -1; }
+              downToID  = (prevID > (_snapOldest -1)) ? prevID : (_snapOldest -1);
+              if (_prevID > downToID) { _skipped += (_prevID - downToID); }
+              if (_highKnown && contBefore((prevID +1), &contPrev)) 
+              {
+                _prevCont = (uint16_t)(_contHigh - contPrev - _prevRead);
+              }
+              _prevID   = prevID;
+              break;
+      case ESPSL_READ_CONTINUED:
+              if (_prevID >= _baseID) { _prevRead++; }
+              _prevID--;
+              break;
+      default:
+              return false;
+    }
+  }
+  return false;
+
+} // readPreviousLine()
+
+//-------------------------------------------------------------------------------------
+//-- returns the lineID of the last line returned
+int32_t ESPSL_Reader::getLineID() 
+{
+  return _lineID;
+
+} // getLineID()
+
+//-------------------------------------------------------------------------------------
+//-- returns the number of lines overwritten by the writer since startReading()
+uint32_t ESPSL_Reader::getSkipped() 
+{
+  if ((uint32_t)(_nextCont + _prevCont) > _skipped) { return 0; }
+  return (_skipped - _nextCont - _prevCont);
+
+} // getSkipped()
+
+//===========================================================================================
+//-- ESPSL_Limiter: rate limit and sampling for one call site
+//===========================================================================================
+ESPSL_Limiter::ESPSL_Limiter(uint16_t perSecond, uint16_t burst, uint16_t sampleEvery) 
+{ 
+  if (burst < 1)  { burst = 1; }
+  _rate         = perSecond;
+  _capacity     = (perSecond > 0) ? (burst * 1000UL) : 0;
+  _tokens       = _capacity;
+  _lastRefill   = millis();
+  _sampleEvery  = (sampleEvery < 1) ? 1 : sampleEvery;
+  _calls        = 0;
+  _suppressed   = 0;
+  _note[0]      = '\0';
+
+} // ESPSL_Limiter()
+
+//-------------------------------------------------------------------------------------
+//-- text to put in front of the line that is written (and start counting again)
+const char *ESPSL_Limiter::note() 
+{
+  if (_suppressed == 0) { return NULL; }
+  snprintf(_note, sizeof(_note), "(%u suppressed) ", _suppressed);
+  _suppressed = 0;
+  return _note;
+
+} // note()
+
+//-------------------------------------------------------------------------------------
+//-- returns the calls suppressed since the last line written
+uint32_t ESPSL_Limiter::getSuppressed() 
+{
+  return _suppressed;
+
+} // getSuppressed()
+
+
+//-------------------------------------------------------------------------------------
+//-- start reading from startLine
+bool ESPSL::dumpLogFile() 
+{
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::dumpLogFile()..\r\n", __LINE__);
+#endif
+
+  int32_t   recKey;
+  uint32_t  offset, seekToLine;
+  memset(globalBuff, 0, sizeof(globalBuff));
+  flushLog();
+      
+  _sysLog  = SPIFFS.open(_sysLogFile, "r+");    //-- open for reading and writing
+
+  checkSysLogFileSize("dumpLogFile():", (_numLines + _numReserved + 1) * (_recLength +1));  //-- add '\n'
+
+  for (recKey = 0; recKey < (_numLines + _numReserved); recKey++) 
+  {
+    seekToLine = recKey +1;
+    offset = (seekToLine * (_recLength +1));
+    if (!_sysLog.seek(offset, SeekSet)) 
+    {
+      printf("ESPSL(%d)::dumpLogFile(): seek to position [%d] (offset %d) failed (now @%d)\r\n", __LINE__
+                                                                                              , seekToLine
+                                                                                              , offset
+                                                                                              , _sysLog.position());
+      return false;
+    }
+    int32_t   lineID;
+    int l = _sysLog.readBytesUntil('\n', globalBuff, _recLength);
+#ifdef _DODEBUG
     if (_Debug(5)) printf("ESPSL(%d)::dumpLogFile():  >>>>> [%d] -> [%s]\r\n", __LINE__, l, globalBuff);
 #endif
-    sscanf(globalBuff,"%u|%[^\0]", &lineID, globalBuff);
+    globalBuff[l] = '\0';
+    lineID = atol(globalBuff);
+    memmove(globalBuff, (globalBuff + _KEYLEN -1), strlen(globalBuff + _KEYLEN -1) +1);  //-- keep separator
+
+    if (lineID == (_lastUsedLineID)) 
+    {
+            printf("(a)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
+
+            println(">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>");
+    }
+    else if (lineID == (_oldestLineID) ) //&& recKey < _numLines)
+            printf("(b)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
+    else if (lineID == _EMPTYID) 
+            printf("(c)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
+    else 
+    {
+       printf("(d)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
+    }
+  } //-- while ..
+
+  return true;
+
+} // dumpLogFile
+
+//-------------------------------------------------------------------------------------
+//-- erase SysLog file from SPIFFS
+boolean ESPSL::removeSysLog() 
+{
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::removeSysLog()..\r\n", __LINE__);
+#endif
+  SPIFFS.remove(_sysLogFile);
+  SPIFFS.remove(_idxFile);
+  SPIFFS.remove(_bootFile);
+  removeArchive();
+  return true;
+  
+} // removeSysLog()
+
+//-------------------------------------------------------------------------------------
+//-- returns ESPSL status info
+void ESPSL::status() 
+{
+  printf("ESPSL::status():       _numLines[%8d]\r\n", _numLines);
+  printf("ESPSL::status():      _lineWidth[%8d]\r\n", _lineWidth);
+  printf("ESPSL::status():    _numReserved[%8d]\r\n", _numReserved);
+  if (_numLines > 0) 
+  {
+    printf("ESPSL::status():   _oldestLineID[%8d] (%2d)\r\n", _oldestLineID
+                                                           , (_oldestLineID % _numLines)+1);
+    printf("ESPSL::status(): _lastUsedLineID[%8d] (%2d)\r\n", _lastUsedLineID
+                                                           , (_lastUsedLineID % _numLines)+1);
+  }
+  printf("ESPSL::status():       _debugLvl[%8d]\r\n", _debugLvl);
+  printf("ESPSL::status():   start: open[%8d]us\r\n", _startOpenUs);
+  printf("ESPSL::status():start: validate[%8d]us\r\n", _startValidateUs);
+  printf("ESPSL::status(): start: recover[%8d]us\r\n", _startRecoverUs);
+  if (_mSeries > 0)
+  {
+    printf("ESPSL::status(): metrics: series[%8d]\r\n", _mSeries);
+    printf("ESPSL::status():    metrics: raw[%8u] of [%d]\r\n", _mSeq[ESPSL_TIER_RAW], _mSlots[ESPSL_TIER_RAW]);
+    printf("ESPSL::status(): metrics: minute[%8u] of [%d]\r\n", _mSeq[ESPSL_TIER_MINUTE], _mSlots[ESPSL_TIER_MINUTE]);
+    printf("ESPSL::status():   metrics: hour[%8u] of [%d]\r\n", _mSeq[ESPSL_TIER_HOUR], _mSlots[ESPSL_TIER_HOUR]);
+  }
+  if (_arcFiles > 0)
+  {
+    printf("ESPSL::status(): archive: oldest[%8d]\r\n", archiveOldestID());
+    printf("ESPSL::status():   archive: last[%8d]\r\n", _arcLastID);
+    printf("ESPSL::status():   archive: file[%8d] size[%d]\r\n", _arcCurrent, _arcSize);
+  }
+#if defined(ESP32)
+  printf("ESPSL::status():  min.free stack[%8d]\r\n", uxTaskGetStackHighWaterMark(NULL));
+#elif defined(ESP8266)
+  printf("ESPSL::status():  min.free stack[%8d]\r\n", ESP.getFreeContStack());
+#endif
+  
+} // status()
+
+//-------------------------------------------------------------------------------------
+void ESPSL::setOutput(HardwareSerial *serIn, int baud)
+{
+  _Serial = serIn;
+  _Serial->begin(baud);
+  _Serial->printf("ESPSL(%d): Serial Output Ready..\r\n", __LINE__);
+  _serialOn = true;
+  
+} // setOutput(hw, baud)
+
+//-------------------------------------------------------------------------------------
+void ESPSL::setOutput(Stream *serIn)
+{
+  _Stream = serIn;
+  _Stream->printf("ESPSL(%d): Stream Output Ready..\r\n", __LINE__);
+  _streamOn = true;
+  
+} // setOutput(Stream)
+
+//-------------------------------------------------------------------------------------
+void ESPSL::print(const char *line)
+{
+  if (_streamOn)  _Stream->print(line);
+  if (_serialOn)  _Serial->print(line);
+  
+} // print()
+
+//-------------------------------------------------------------------------------------
+void ESPSL::println(const char *line)
+{
+  if (_streamOn)  _Stream->println(line);
+  if (_serialOn)  _Serial->println(line);
+  
+} // println()
+
+//-------------------------------------------------------------------------------------
+void ESPSL::printf(const char *fmt, ...)
+{
+#ifdef _LOWMEMORY
+  char lineBuff[_MINLINEWIDTH +1];    //-- long (debug) messages are cut off
+#else
+  char lineBuff[(_MAXLINEWIDTH + 101)];
+#endif
+
+  va_list args;
+  va_start (args, fmt);
+  vsnprintf(lineBuff, sizeof(lineBuff), fmt, args);
+  va_end (args);
+
+  if (_streamOn)  _Stream->print(lineBuff);
+  if (_serialOn)  _Serial->print(lineBuff);
+
+} // printf()
+
+//-------------------------------------------------------------------------------------
+void ESPSL::flush()
+{
+  if (_streamOn)  _Stream->flush();
+  if (_serialOn)  _Serial->flush();
+  
+} // flush()
+  
+//-------------------------------------------------------------------------------------
+//-- check fileSize of _sysLogFile
+boolean ESPSL::checkSysLogFileSize(const char* func, int32_t cSize)
+{
+#ifdef _DODEBUG
+  if (_Debug(4)) printf("ESPSL(%d)::checkSysLogFileSize(%d)..\r\n", __LINE__, cSize);
+#endif
+  int32_t fileSize = (_sysLog ? (int32_t)_sysLog.size() : 0);
+  if (fileSize != cSize) 
+  {
+    printf("ESPSL(%d)::%s -> [%s] size is [%d] but should be [%d] .. error!\r\n"
+                                                          , __LINE__
+                                                          , func
+                                                          , _sysLogFile
+                                                          , fileSize, cSize);
+    return false;
+  }
+  return true;
+
+} // checkSysLogSize()
+
+
+//-------------------------------------------------------------------------------------
+//-- returns lastUsed LineID
+uint32_t ESPSL::getLastLineID()
+{
+  return _lastUsedLineID;
+  
+} // getLastLineID()
+
+//-------------------------------------------------------------------------------------
+//-- returns oldest LineID still in the log (the ring, the reserved region or the archive)
+int32_t ESPSL::getOldestLineID()
+{
+  return nextLineID(1);
+  
+} // getOldestLineID()
+
+//-------------------------------------------------------------------------------------
+//-- returns the severity level of the last line read
+uint8_t ESPSL::getLineLevel()
+{
+  return _readLevel;
+  
+} // getLineLevel()
+
+//-------------------------------------------------------------------------------------
+//-- keep the last reservedLines warnings and errors apart from the ring (the
+//-- logfile is re-created by begin() if this does not match the logfile)
+void ESPSL::setRetention(uint16_t reservedLines)
+{
+  _retainLines = reservedLines;
+  
+} // setRetention()
+
+//-------------------------------------------------------------------------------------
+//-- a line longer than lineWidth -1 chars continues in up to maxRecords -1 
+//-- continuation records (1 -> longer lines are cut off)
+void ESPSL::setContinuation(uint8_t maxRecords)
+{
+  _maxRecords = (maxRecords < 1) ? 1 : maxRecords;
+
+  //-- the buffers for long lines are only needed from here on (and kept)
+  if ((_maxRecords > 1) && (_msgBuff == NULL) && (_MAXMSGLEN > _MAXLINEWIDTH))
+  {
+    _msgBuff = (char*)malloc(_MSGBUFFLEN + _LINEBUFFLEN);
+    if (_msgBuff == NULL)
+    {
+      printf("ESPSL(%d)::setContinuation(): no memory for long lines\r\n", __LINE__);
+      return;
+    }
+    _lineBuff = (_msgBuff + _MSGBUFFLEN);
+  }
+  
+} // setContinuation()
+
+//-------------------------------------------------------------------------------------
+//-- max. length of a line, limited by what readRecord() can put together in msgBuff()
+uint16_t ESPSL::msgLength()
+{
+  uint16_t records;
+
+  if (_lineWidth < _MINLINEWIDTH) { return (_MINLINEWIDTH -1); }   //-- begin() not called
+  records = (((_msgBuff != NULL) ? _MAXMSGLEN : _MAXLINEWIDTH) - _KEYLEN) / (_lineWidth -1);
+
+  if (records > _maxRecords) { records = _maxRecords; }
+  if (records < 1)           { records = 1; }
+  return (records * (_lineWidth -1));
+  
+} // msgLength()
+
+//-------------------------------------------------------------------------------------
+//-- the buffer a line is formatted or put together in (call with the file locked)
+char *ESPSL::msgBuff()
+{
+  return (_msgBuff != NULL) ? _msgBuff : globalBuff;
+  
+} // msgBuff()
+
+//-------------------------------------------------------------------------------------
+int ESPSL::msgBuffLen()
+{
+  return (_msgBuff != NULL) ? _MSGBUFFLEN : sizeof(globalBuff);
+  
+} // msgBuffLen()
+
+//-------------------------------------------------------------------------------------
+//-- the buffer for the lines a read path hands out: localBuff (big enough for one
+//-- record) unless setContinuation() allocated _lineBuff. When _lineBuff is in use 
+//-- (a callback that reads again, another task) a temporary one is allocated
+char *ESPSL::takeLineBuff(char *localBuff, int *buffLen)
+{
+  char *lineBuff = localBuff;
+
+  if (_lineBuff == NULL) { return localBuff; }
+
+  _LOCKFILE();
+  if (!_lineBuffTaken)
+  {
+    _lineBuffTaken = true;
+    lineBuff = _lineBuff;
+  }
+  else if ((lineBuff = (char*)malloc(_LINEBUFFLEN)) == NULL)
+  {
+    lineBuff = localBuff;
+  }
+  _UNLOCKFILE();
+  if (lineBuff != localBuff) { *buffLen = _LINEBUFFLEN; }
+
+  return lineBuff;
+
+} // takeLineBuff()
+
+//-------------------------------------------------------------------------------------
+void ESPSL::giveLineBuff(char *lineBuff, char *localBuff)
+{
+  if (lineBuff == localBuff) { return; }
+
+  _LOCKFILE();
+  if (lineBuff == _lineBuff)  { _lineBuffTaken = false; }
+  else                        { free(lineBuff); }
+  _UNLOCKFILE();
+
+} // giveLineBuff()
+
+//-------------------------------------------------------------------------------------
+//-- set Debug Level
+void ESPSL::setDebugLvl(int8_t debugLvl)
+{
+  if (debugLvl >= 0 && debugLvl <= 9)
+        _debugLvl = debugLvl;
+  else  _debugLvl = 1;
+  
+} // setDebugLvl
+
+//-------------------------------------------------------------------------------------
+//-- set duplicate-message suppression mode and the time after which
+//-- a pending "repeated" counter is written anyway
+void ESPSL::setDuplicateFilter(uint8_t mode, uint32_t commitAfterMs)
+{
+  commitRepeats();
+  _dedupMode    = mode;
+  _dedupTimeout = commitAfterMs;
+  _dedupValid   = false;
+  
+} // setDuplicateFilter()
+
+//-------------------------------------------------------------------------------------
+//-- housekeeping, call this from the main loop()
+void ESPSL::loop()
+{
+  if ((_dedupCount > 0) && ((millis() - _dedupSince) >= _dedupTimeout))
+  {
+    commitRepeats();
+  }
+  if ((_batchCount > 0) && (_flushDelay > 0) && ((millis() - _batchSince) >= _flushDelay))
+  {
+    flushLog();
+  }
+  if ((_batchCount > 0) && (_idleMs > 0) && ((millis() - _batchLast) >= _idleMs))
+  {
+    flushLog();     //-- nothing logged for a while, a good moment to write
+  }
+  if (_fwdUdp != NULL)
+  {
+    forward();
+  }
+  
+} // loop()
+
+//-------------------------------------------------------------------------------------
+//-- hold up to maxBatch records in RAM and flush them together, but
+//-- never keep a record longer than maxDelayMs (0 -> until the batch is full)
+void ESPSL::setFlushPolicy(uint16_t maxBatch, uint32_t maxDelayMs)
+{
+  if (maxBatch < 1)         { maxBatch = 1; }
+  if (maxBatch > _MAXBATCH) { maxBatch = _MAXBATCH; }
+#ifdef _LOWMEMORY
+  maxBatch = 1;     //-- no RAM for a batch buffer
+#endif
+  flushLog();
+  _sleepBytes     = 0;
+  _idleMs         = 0;
+  _batchMin       = maxBatch;
+  _batchMax       = maxBatch;
+  _flushDelayMin  = maxDelayMs;
+  _flushDelay     = maxDelayMs;
+  
+} // setFlushPolicy()
+
+//-------------------------------------------------------------------------------------
+//-- hold records in RAM and write them in one go: when flushAtBytes are held, when 
+//-- nothing was logged for idleMs (0 -> never), or by prepareForSleep() / flushLog()
+//-- flushAtBytes 0 -> write every record immediately again
+void ESPSL::setSleepPolicy(uint32_t flushAtBytes, uint32_t idleMs)
+{
+  flushLog();
+  _sleepBytes     = flushAtBytes;
+  _idleMs         = idleMs;
+  _batchMin       = (flushAtBytes > 0) ? sleepBatchSize() : 1;
+  _batchMax       = _batchMin;
+  _flushDelayMin  = 0;
+  _flushDelay     = 0;
+  _wearBudget     = 0.0;    //-- no adaptive policy
+  
+} // setSleepPolicy()
+
+//-------------------------------------------------------------------------------------
+//-- call just before a (deep) sleep. On the ESP32 the records held by setSleepPolicy() 
+//-- stay in RTC memory (no flash write) and begin() takes them back after waking up,
+//-- otherwise they are written to flash
+boolean ESPSL::prepareForSleep()
+{
+  if (_dedupCount > 0)  { commitRepeats(); }
+  if (_fwdUdp != NULL)  { saveForwardState(); }
+#if defined(ESP32)
+  if ((_batchBuff != NULL) && (_batchBuff == _rtcBatch.records))
+  {
+    keepBatch();
+    return true;
+  }
+#endif
+  return flushLog();
+  
+} // prepareForSleep()
+
+//-------------------------------------------------------------------------------------
+//-- returns the number of times the flash was written to (a proxy for energy use)
+uint32_t ESPSL::getFlashSessions()
+{
+  return _statFlushes;
+  
+} // getFlashSessions()
+
+//-------------------------------------------------------------------------------------
+//-- returns the time spent writing records to flash
+uint32_t ESPSL::getFlashActiveMs()
+{
+  return (uint32_t)(_statFlashUs / 1000);
+  
+} // getFlashActiveMs()
+
+//-------------------------------------------------------------------------------------
+//-- max. number of erase cycles per day the log may consume (0 -> no limit)
+void ESPSL::setWearBudget(float erasesPerDay)
+{
+  _wearBudget = erasesPerDay;
+  if (_wearBudget <= 0.0)
+  {
+    flushLog();
+    _batchMax   = _batchMin;
+    _flushDelay = _flushDelayMin;
+  }
+  _wearWinStart = millis();
+  _wearWinPages = 0;
+  
+} // setWearBudget()
+
+//-------------------------------------------------------------------------------------
+//-- returns estimated erase cycles per day caused by the log (-1 if not yet known)
+float ESPSL::getErasesPerDay()
+{
+  uint32_t  elapsed = millis() - _wearStart;
+
+  if (elapsed < _WEARWINDOW) { return -1.0; }
+  return ((float)_statPages * _fsPageSize / _fsBlockSize) * (86400000.0 / elapsed);
+  
+} // getErasesPerDay()
+
+//-------------------------------------------------------------------------------------
+//-- returns the days it takes the log to wear out the FS (-1 if not yet known)
+float ESPSL::getProjectedLifetime()
+{
+  float erasesPerDay = getErasesPerDay();
+
+  if (erasesPerDay <= 0.0) { return -1.0; }
+  //-- SPIFFS spreads the erases over all blocks
+  return ((float)_FLASHENDURANCE * _fsBlocks) / erasesPerDay;
+  
+} // getProjectedLifetime()
+
+//-------------------------------------------------------------------------------------
+//-- display wear statistics
+void ESPSL::wearStatus()
+{
+  float erasesPerDay = getErasesPerDay();
+  float lifetime     = getProjectedLifetime();
+
+  printf("ESPSL::wearStatus():      records[%8d]\r\n", _statRecords);
+  printf("ESPSL::wearStatus():        bytes[%8d]\r\n", _statBytes);
+  printf("ESPSL::wearStatus():  flash pages[%8d] (%d bytes/page)\r\n", _statPages, _fsPageSize);
+  printf("ESPSL::wearStatus():      flushes[%8d]\r\n", _statFlushes);
+  printf("ESPSL::wearStatus(): flash active[%8d]ms\r\n", getFlashActiveMs());
+  if (_statBytes > 0)
+  {
+    printf("ESPSL::wearStatus(): write ampl. [%8d]%%\r\n"
+                          , (int)((100.0 * _statPages * _fsPageSize) / _statBytes));
+  }
+  printf("ESPSL::wearStatus(): erases/day  [%8d]\r\n", (int)erasesPerDay);
+  printf("ESPSL::wearStatus(): lifetime    [%8d] days (%d blocks)\r\n", (int)lifetime, _fsBlocks);
+  printf("ESPSL::wearStatus(): batch/delay [%8d] [%d]ms\r\n", _batchMax, _flushDelay);
+  
+} // wearStatus()
+
+//-------------------------------------------------------------------------------------
+//-- forward the log to a (RFC 5424) syslog collector, loop() does the sending
+boolean ESPSL::setSyslogServer(const char *server, uint16_t port
+                             , const char *hostName, const char *appName)
+{
+  File fwdState;
+  char stateBuff[24] = {0};    //-- "<lineID>;<generation>"
+
+  strlcpy(_fwdServer,   server,   sizeof(_fwdServer));
+  strlcpy(_fwdHostName, hostName, sizeof(_fwdHostName));
+  strlcpy(_fwdAppName,  appName,  sizeof(_fwdAppName));
+  _fwdPort      = port;
+  _fwdResolved  = false;
+  if (_fwdUdp == NULL) { _fwdUdp = new WiFiUDP(); }
+
+  //-- resume where we were before the reset (forward() checks the generation)
+  _fwdLastID     = 0;
+  _fwdGeneration = 0;         //-- files of older versions only have the lineID
+  fwdState   = SPIFFS.open(_fwdFile, "r");
+  if (fwdState)
+  {
+    fwdState.readBytesUntil('\n', stateBuff, sizeof(stateBuff) -1);
+    fwdState.close();
+    _fwdLastID = atol(stateBuff);
+    if (strchr(stateBuff, ';') != NULL) { _fwdGeneration = atol(strchr(stateBuff, ';') +1); }
+  }
+  _fwdSavedID = _fwdLastID;
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::setSyslogServer(%s:%d) resume after [%d]\r\n", __LINE__
+                                                                                 , _fwdServer, _fwdPort
+                                                                                 , _fwdLastID);
+#endif
+  return true;
+  
+} // setSyslogServer()
+
+//-------------------------------------------------------------------------------------
+//-- max. lines packed in one datagram and max. datagrams per second. RFC 5426 allows
+//-- one message per datagram, more lines are only packed if nonStandard is true
+void ESPSL::setForwardLimits(uint8_t linesPerDatagram, uint16_t datagramsPerSecond
+                           , boolean nonStandard)
+{
+  if ((linesPerDatagram > 1) && !nonStandard)
+  {
+    printf("ESPSL(%d)::setForwardLimits(%d, ..): one line per datagram (RFC 5426)\r\n", __LINE__
+                                                                                  , linesPerDatagram);
+    linesPerDatagram = 1;
+  }
+  _fwdLines    = (linesPerDatagram < 1)   ? 1 : linesPerDatagram;
+  _fwdInterval = (datagramsPerSecond < 1) ? 1000 : (1000 / datagramsPerSecond);
+  
+} // setForwardLimits()
+
+//-------------------------------------------------------------------------------------
+//-- send the next datagram with not yet forwarded lines (if the rate limit allows)
+//-- returns the number of lines sent
+int16_t ESPSL::forward()
+{
+  int32_t   lineID, oldestID;
+  int32_t   flushedID = (_lastUsedLineID - _batchCount);   //-- held lines might get lost
+  int16_t   lines = 0;
+  uint16_t  bytes = 0;
+  char      header[160];     //-- room for the timestamp and the longest host and app name
+  char      timestamp[24];   //-- "2019-01-01T00:00:00Z" or NILVALUE
+  time_t    now = time(NULL);
+  struct tm tmNow;
+  char      lineLocal[_MAXLINEWIDTH + _KEYLEN];
+  int       lineLen = sizeof(lineLocal);
+  char     *lineIn;
+  static const uint8_t severity[] = { 7, 6, 4, 3 };   //-- debug, info, warning, error
+
+  if (_fwdUdp == NULL)                              { return 0; }
+  if (WiFi.status() != WL_CONNECTED)                { return 0; }
+  if ((millis() - _fwdLastSend) < _fwdInterval)     { return 0; }
+
+  if (_fwdGeneration != _generation)  //-- a new logfile, start all over
+  {
+    _fwdLastID     = 0;
+    _fwdGeneration = _generation;
+  }
+  if (_fwdLastID >= flushedID) { return 0; }
+
+  if (!_fwdResolved)
+  {
+    _fwdResolved = WiFi.hostByName(_fwdServer, _fwdIP);
+    if (!_fwdResolved) 
+    {
+      printf("ESPSL(%d)::forward(): cannot resolve [%s]\r\n", __LINE__, _fwdServer);
+      _fwdLastSend = millis();
+      return 0;
+    }
+  }
+
+  //-- the time the line is sent, once the clock is set
+  strlcpy(timestamp, "-", sizeof(timestamp));
+  if ((now >= _FWDTIMEVALID) && (gmtime_r(&now, &tmNow) != NULL))
+  {
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &tmNow);
+  }
+
+  oldestID = getOldestLineID();
+  if (_fwdLastID < (oldestID -1))
+  {
+    _fwdLost  += (oldestID -1) - _fwdLastID;
+    _fwdLastID = oldestID -1;
+  }
+
+  lineIn = takeLineBuff(lineLocal, &lineLen);
+  for (lineID = nextLineID(_fwdLastID +1); (lineID <= flushedID) && (lines < _fwdLines)
+                                         ; lineID = nextLineID(lineID +1))
+  {
+    if (readLine(lineID, lineIn, lineLen) != ESPSL_READ_OK)     { continue; }
+    //-- a line without text would be a message without MSG part
+    if (lineIn[strspn(lineIn, " \t")] == '\0')                       { continue; }
+    //-- <PRI>VERSION TIMESTAMP HOSTNAME APP-NAME PROCID MSGID [SD] MSG
+    snprintf(header, sizeof(header), "%s<%d>1 %s %s %s - - [meta sequenceId=\"%d\"] "
+                                                          , (lines > 0 ? "\n" : "")
+                                                          , ((_FWDFACILITY * 8) + severity[_readLevel])
+                                                          , timestamp
+                                                          , _fwdHostName
+                                                          , _fwdAppName
+                                                          , lineID);
+    if ((lines > 0) && ((bytes + strlen(header) + strlen(lineIn)) > _FWDMAXDATAGRAM)) { break; }
+    if (lines == 0) { _fwdUdp->beginPacket(_fwdIP, _fwdPort); }
+    bytes += _fwdUdp->print(header);
+    bytes += _fwdUdp->print(lineIn);
+    lines++;
+  }
+  giveLineBuff(lineIn, lineLocal);
+  if (lines == 0)
+  {
+    _fwdLastID = lineID -1;   //-- only empty lines, nothing to send
+    return 0;
+  }
+  if (!_fwdUdp->endPacket())
+  {
+#ifdef _DODEBUG
+    if (_Debug(2)) printf("ESPSL(%d)::forward(): sending to [%s] failed\r\n", __LINE__, _fwdServer);
+#endif
+    _fwdLastSend = millis();
+    return 0;
+  }
+  _fwdLastID   = lineID -1;
+  _fwdLastSend = millis();
+
+  if ((millis() - _fwdLastSave) >= _FWDSAVEINTERVAL) { saveForwardState(); }
+
+  return lines;
+  
+} // forward()
+
+//-------------------------------------------------------------------------------------
+//-- remember the last forwarded lineID in SPIFFS
+void ESPSL::saveForwardState()
+{
+  File fwdState;
+
+  _fwdLastSave = millis();
+  if (_fwdLastID == _fwdSavedID) { return; }
+
+  fwdState = SPIFFS.open(_fwdFile, "w");
+  if (!fwdState)
+  {
+    printf("ESPSL(%d)::saveForwardState(): Some error opening [%s]\r\n", __LINE__, _fwdFile);
+    return;
+  }
+  fwdState.printf("%d;%d\n", _fwdLastID, _fwdGeneration);
+  fwdState.close();
+  _fwdSavedID = _fwdLastID;
+  
+} // saveForwardState()
+
+//-------------------------------------------------------------------------------------
+//-- returns the last lineID sent to the syslog collector
+int32_t ESPSL::getForwardedLineID()
+{
+  return _fwdLastID;
+  
+} // getForwardedLineID()
+
+
+//===========================================================================================
+//-- Boot sessions: begin() writes a boot line and keeps the lineID of that line for the 
+//-- last _MAXSESSIONS boots in _bootFile ([bootCount, firstID[_MAXSESSIONS]])
+//===========================================================================================
+void ESPSL::startSession()
+{
+  File      bootFile;
+  char      reason[32];
+  int32_t   firstID = _lastUsedLineID +1;
+
+  _bootCount = 0;
+  bootFile   = SPIFFS.open(_bootFile, "r");
+  if (bootFile) 
+  {
+    if (   (bootFile.read((uint8_t*)&_bootCount, sizeof(_bootCount)) != sizeof(_bootCount))
+        || (bootFile.read((uint8_t*)_sessionIDs, sizeof(_sessionIDs)) != sizeof(_sessionIDs)) )
+    {
+      _bootCount = 0;
+    }
+    bootFile.close();
+  }
+  //-- a table that does not fit this logfile is useless
+  for (uint8_t s = 0; (s < _MAXSESSIONS) && (s < _bootCount); s++)
+  {
+    if (_sessionIDs[s] > firstID) { _bootCount = 0; }
+  }
+
+  _sessionIDs[_bootCount % _MAXSESSIONS] = firstID;
+  _bootCount++;
+
+  bootFile = SPIFFS.open(_bootFile, "w");
+  if (!bootFile)
+  {
+    printf("ESPSL(%d)::startSession(): Some error opening [%s]\r\n", __LINE__, _bootFile);
+  }
+  else
+  {
+    bootFile.write((const uint8_t*)&_bootCount, sizeof(_bootCount));
+    bootFile.write((const uint8_t*)_sessionIDs, sizeof(_sessionIDs));
+    bootFile.close();
+  }
+
+#if defined(ESP8266)
+  strlcpy(reason, ESP.getResetReason().c_str(), sizeof(reason));
+#elif defined(ESP32)
+  switch(esp_reset_reason())
+  {
+    case ESP_RST_POWERON:   strlcpy(reason, "Power on", sizeof(reason));            break;
+    case ESP_RST_EXT:       strlcpy(reason, "External reset", sizeof(reason));      break;
+    case ESP_RST_SW:        strlcpy(reason, "Software reset", sizeof(reason));      break;
+    case ESP_RST_PANIC:     strlcpy(reason, "Exception/panic", sizeof(reason));     break;
+    case ESP_RST_INT_WDT:   strlcpy(reason, "Interrupt watchdog", sizeof(reason));  break;
+    case ESP_RST_TASK_WDT:  strlcpy(reason, "Task watchdog", sizeof(reason));       break;
+    case ESP_RST_WDT:       strlcpy(reason, "Other watchdog", sizeof(reason));      break;
+    case ESP_RST_DEEPSLEEP: strlcpy(reason, "Deep sleep", sizeof(reason));          break;
+    case ESP_RST_BROWNOUT:  strlcpy(reason, "Brownout", sizeof(reason));            break;
+    default:                strlcpy(reason, "Unknown", sizeof(reason));
+  }
+#else
+  strlcpy(reason, "Unknown", sizeof(reason));
+#endif
+  writef(_BOOTLINE, _bootCount, reason);
+
+} // startSession()
+
+
+//-------------------------------------------------------------------------------------
+//-- returns the number of boot sessions that can be read
+uint8_t ESPSL::getSessionCount()
+{
+  uint8_t sessions = (_bootCount < _MAXSESSIONS) ? _bootCount : _MAXSESSIONS;
+
+  //-- sessions that are completely overwritten are gone
+  while ((sessions > 0) && (getSessionEndID(sessions -1) < getOldestLineID())) { sessions--; }
+  return sessions;
+
+} // getSessionCount()
+
+
+//-------------------------------------------------------------------------------------
+//-- returns the lineID of the boot line of session (0 = this boot), 0 if unknown
+int32_t ESPSL::getSessionStartID(uint8_t session)
+{
+  if ((session >= _MAXSESSIONS) || (session >= _bootCount)) { return 0; }
+  return _sessionIDs[(_bootCount -1 -session) % _MAXSESSIONS];
+
+} // getSessionStartID()
+
+
+//-------------------------------------------------------------------------------------
+//-- returns the last lineID of session (0 = this boot), 0 if unknown
+int32_t ESPSL::getSessionEndID(uint8_t session)
+{
+  if ((session >= _MAXSESSIONS) || (session >= _bootCount)) { return 0; }
+  if (session == 0) { return _lastUsedLineID; }
+  return (getSessionStartID(session -1) -1);
+
+} // getSessionEndID()
+
+
+//-------------------------------------------------------------------------------------
+//-- hand the lines of session (0 = this boot) still in the log to callback()
+//-- stops early if callback() returns false
+int16_t ESPSL::readSession(uint8_t session, ESPSL_lineCallback callback)
+{
+  int32_t   lineID, endID;
+  int16_t   lines = 0;
+  char      lineLocal[_MAXLINEWIDTH + _KEYLEN];
+  int       lineLen = sizeof(lineLocal);
+  char     *lineIn;
+
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::readSession(%d)\r\n", __LINE__, session);
+#endif
+  if (getSessionStartID(session) == 0)  { return 0; }
+  endID  = getSessionEndID(session);
+  lineIn = takeLineBuff(lineLocal, &lineLen);
+  for (lineID = nextLineID(getSessionStartID(session)); lineID <= endID; lineID = nextLineID(lineID +1))
+  {
+    if (readLine(lineID, lineIn, lineLen) != ESPSL_READ_OK)     { continue; }
+    lines++;
+    if (!callback(lineID, lineIn))                              { break; }
+  }
+  giveLineBuff(lineIn, lineLocal);
+
+  return lines;
+
+} // readSession()
+
+
+//===========================================================================================
+//-- Metrics: fixed size binary samples in _metricsFile, next to the text log. Every tier 
+//-- (raw, minute, hour) is a ring of its own, record seq lives in slot (seq % slots).
+//--   header  [magic, numSeries, raw, minute, hour]
+//--   raw     [seq, time, value[numSeries]]
+//--   minute  [seq, time, count, min[numSeries], avg[numSeries], max[numSeries]]
+//--   hour    like minute
+//-- The minute and the hour that are being collected are kept in RAM (_mAcc), begin()
+//-- puts them together again from the tier below.
+//===========================================================================================
+static const uint32_t _PERIOD[] = { 1, 60, 3600 };   //-- seconds per record of every tier
+
+//-- add sample (avgV is an average) to acc (avgV is the sum while collecting)
+static void metricAdd(ESPSL_Sample *acc, const ESPSL_Sample &sample, uint8_t numSeries, uint32_t period)
+{
+  if (acc->count == 0)
+  {
+    acc->time = sample.time - (sample.time % period);
+    for (uint8_t v = 0; v < numSeries; v++)
+    {
+      acc->minV[v] = sample.minV[v];
+      acc->avgV[v] = 0.0;
+      acc->maxV[v] = sample.maxV[v];
+    }
+  }
+  for (uint8_t v = 0; v < numSeries; v++)
+  {
+    if (sample.minV[v] < acc->minV[v]) { acc->minV[v] = sample.minV[v]; }
+    if (sample.maxV[v] > acc->maxV[v]) { acc->maxV[v] = sample.maxV[v]; }
+    acc->avgV[v] += (sample.avgV[v] * sample.count);
+  }
+  acc->count += sample.count;
+
+} // metricAdd()
+
+//-- acc as a sample (sums -> averages)
+static void metricClose(const ESPSL_Sample *acc, ESPSL_Sample *sample, uint8_t numSeries)
+{
+  *sample = *acc;
+  for (uint8_t v = 0; v < numSeries; v++)
+  {
+    sample->avgV[v] = (acc->count > 0) ? (acc->avgV[v] / acc->count) : 0.0;
+  }
+
+} // metricClose()
+
+
+//-------------------------------------------------------------------------------------
+//-- numSeries values per sample, keep the last rawSamples samples, minuteSamples 
+//-- minutes and hourSamples hours (0 -> no such tier). 0 numSeries -> no metrics
+void ESPSL::setMetrics(uint8_t numSeries, uint16_t rawSamples, uint16_t minuteSamples, uint16_t hourSamples)
+{
+  if (numSeries > ESPSL_MAXSERIES) { numSeries = ESPSL_MAXSERIES; }
+  _mSeries = numSeries;
+  _mSlots[ESPSL_TIER_RAW]    = rawSamples;
+  _mSlots[ESPSL_TIER_MINUTE] = minuteSamples;
+  _mSlots[ESPSL_TIER_HOUR]   = hourSamples;
+  
+} // setMetrics()
+
+
+//-------------------------------------------------------------------------------------
+uint16_t ESPSL::metricSize(uint8_t tier)
+{
+  if (tier == ESPSL_TIER_RAW) { return (8 + (4 * _mSeries)); }
+  return (12 + (12 * _mSeries));
+
+} // metricSize()
+
+//-- position of record seq of tier in _metricsFile
+uint32_t ESPSL::metricOffset(uint8_t tier, uint32_t seq)
+{
+  uint32_t offset = (5 * sizeof(int32_t));
+
+  for (uint8_t t = 0; t < tier; t++) { offset += (_mSlots[t] * metricSize(t)); }
+  if (_mSlots[tier] == 0) { return offset; }
+  return offset + ((seq % _mSlots[tier]) * metricSize(tier));
+
+} // metricOffset()
+
+
+//-------------------------------------------------------------------------------------
+//-- read record seq of tier, false if it is not (or no longer) there
+boolean ESPSL::readMetric(File &mFile, uint8_t tier, uint32_t seq, ESPSL_Sample *sample)
+{
+  uint8_t   rec[12 + (12 * ESPSL_MAXSERIES)];
+  uint32_t  recSeq;
+  uint16_t  size = metricSize(tier);
+  uint8_t   n    = _mSeries;
+
+  if ((seq == 0) || (_mSlots[tier] == 0))                                     { return false; }
+  if (!mFile.seek(metricOffset(tier, seq), SeekSet) || (mFile.read(rec, size) != size)) { return false; }
+  memcpy(&recSeq, rec, 4);
+  if (recSeq != seq)                                                          { return false; }
+  memcpy(&sample->time, (rec +4), 4);
+  if (tier == ESPSL_TIER_RAW)
+  {
+    sample->count = 1;
+    memcpy(sample->avgV, (rec +8), (4 * n));
+    memcpy(sample->minV, sample->avgV, (4 * n));
+    memcpy(sample->maxV, sample->avgV, (4 * n));
+    return true;
+  }
+  memcpy(&sample->count, (rec +8), 2);
+  memcpy(sample->minV, (rec +12), (4 * n));
+  memcpy(sample->avgV, (rec +12 + (4 * n)), (4 * n));
+  memcpy(sample->maxV, (rec +12 + (8 * n)), (4 * n));
+  return true;
+
+} // readMetric()
+
+
+//-------------------------------------------------------------------------------------
+//-- write sample as the next record of tier
+boolean ESPSL::writeMetric(File &mFile, uint8_t tier, const ESPSL_Sample &sample)
+{
+  uint8_t   rec[12 + (12 * ESPSL_MAXSERIES)];
+  uint32_t  seq    = _mSeq[tier] +1;
+  uint32_t  offset = metricOffset(tier, seq);
+  uint16_t  size   = metricSize(tier);
+  uint8_t   n      = _mSeries;
+  uint32_t  started;
+
+  if (_mSlots[tier] == 0) { return true; }
+  memset(rec, 0, sizeof(rec));
+  memcpy(rec, &seq, 4);
+  memcpy((rec +4), &sample.time, 4);
+  if (tier == ESPSL_TIER_RAW)
+  {
+    memcpy((rec +8), sample.avgV, (4 * n));
+  }
+  else
+  {
+    memcpy((rec +8), &sample.count, 2);
+    memcpy((rec +12), sample.minV, (4 * n));
+    memcpy((rec +12 + (4 * n)), sample.avgV, (4 * n));
+    memcpy((rec +12 + (8 * n)), sample.maxV, (4 * n));
+  }
+  started = micros();
+  if (!mFile.seek(offset, SeekSet) || (mFile.write(rec, size) != size))
+  {
+    printf("ESPSL(%d)::writeMetric(): Some error writing [%s]\r\n", __LINE__, _metricsFile);
+    return false;
+  }
+  _statFlashUs += (micros() - started);
+  countFlashWrite(offset, size);
+  _mSeq[tier] = seq;
+  return true;
+
+} // writeMetric()
+
+
+//-------------------------------------------------------------------------------------
+//-- open (or create) _metricsFile and find the last record of every tier
+boolean ESPSL::loadMetrics() 
+{
+  File      mFile;
+  int32_t   header[5] = { 0, 0, 0, 0, 0 };
+  uint32_t  fileSize  = metricOffset(ESPSL_TIER_HOUR, 0) + (_mSlots[ESPSL_TIER_HOUR] * metricSize(ESPSL_TIER_HOUR));
+  uint8_t   zeros[64];
+
+#ifdef _DODEBUG
+  if (_Debug(1)) printf("ESPSL(%d)::loadMetrics()..\r\n", __LINE__);
+#endif
+  memset(_mSeq, 0, sizeof(_mSeq));
+  memset(_mAcc, 0, sizeof(_mAcc));
+
+  mFile = SPIFFS.open(_metricsFile, "r");
+  if (mFile) 
+  {
+    mFile.read((uint8_t*)header, sizeof(header));
+    if (mFile.size() != fileSize) { header[0] = 0; }
+    mFile.close();
+  }
+  if (   (header[0] != _METRICSMAGIC) || (header[1] != _mSeries) 
+      || (header[2] != _mSlots[ESPSL_TIER_RAW]) || (header[3] != _mSlots[ESPSL_TIER_MINUTE]) 
+      || (header[4] != _mSlots[ESPSL_TIER_HOUR]) )
+  {
+    printf("ESPSL(%d)::loadMetrics(): create [%s]\r\n", __LINE__, _metricsFile);
+    mFile = SPIFFS.open(_metricsFile, "w");
+    if (!mFile) 
+    {
+      printf("ESPSL(%d)::loadMetrics(): Some error opening [%s]\r\n", __LINE__, _metricsFile);
+      _mSeries = 0;
+      return false;
+    }
+    header[0] = _METRICSMAGIC;
+    header[1] = _mSeries;
+    header[2] = _mSlots[ESPSL_TIER_RAW];
+    header[3] = _mSlots[ESPSL_TIER_MINUTE];
+    header[4] = _mSlots[ESPSL_TIER_HOUR];
+    mFile.write((const uint8_t*)header, sizeof(header));
+    //-- seq 0 -> empty record
+    memset(zeros, 0, sizeof(zeros));
+    for (uint32_t p = sizeof(header); p < fileSize; p += sizeof(zeros))
+    {
+      yield();
+      mFile.write(zeros, (((fileSize - p) < sizeof(zeros)) ? (fileSize - p) : sizeof(zeros)));
+    }
+    mFile.close();
+    return true;
+  }
+
+  //-- the last record of a tier has the highest seq
+  mFile = SPIFFS.open(_metricsFile, "r");
+  for (uint8_t tier = ESPSL_TIER_RAW; tier <= ESPSL_TIER_HOUR; tier++)
+  {
+    for (uint32_t slot = 0; slot < _mSlots[tier]; slot++)
+    {
+      uint32_t seq;
+      
+      if (   !mFile.seek((metricOffset(tier, 0) + (slot * metricSize(tier))), SeekSet)
+          || (mFile.read((uint8_t*)&seq, 4) != 4) ) { break; }
+      if (((seq % _mSlots[tier]) == slot) && (seq > _mSeq[tier])) { _mSeq[tier] = seq; }
+    }
+  }
+  rebuildMetrics(mFile, ESPSL_TIER_MINUTE);
+  rebuildMetrics(mFile, ESPSL_TIER_HOUR);
+  mFile.close();
+
+  return true;
+
+} // loadMetrics()
+
+
+//-------------------------------------------------------------------------------------
+//-- the minute (hour) that was being collected: the last records of the tier below
+//-- (the minutes, or the raw samples without a minute tier) that are in the same 
+//-- period and that are newer than the last record of tier
+void ESPSL::rebuildMetrics(File &mFile, uint8_t tier)
+{
+  ESPSL_Sample *acc    = &_mAcc[tier -1];
+  ESPSL_Sample  sample;
+  uint8_t       from   = tier -1;
+  uint32_t      period = _PERIOD[tier];
+  uint32_t      seq, done = UINT32_MAX;
+
+  if ((from == ESPSL_TIER_MINUTE) && (_mSlots[from] == 0)) { from = ESPSL_TIER_RAW; }
+  if (readMetric(mFile, tier, _mSeq[tier], &sample)) { done = (sample.time / period); }
+
+  for (seq = _mSeq[from]; (seq > 0) && ((seq + _mSlots[from]) > _mSeq[from]); seq--)
+  {
+    if (!readMetric(mFile, from, seq, &sample))                         { break; }
+    if ((sample.time / period) == done)                                 { break; }
+    if ((acc->count > 0) && ((sample.time / period) != (acc->time / period))) { break; }
+    metricAdd(acc, sample, _mSeries, period);
+  }
+  //-- the hour includes the minute being collected
+  if (   (from == ESPSL_TIER_MINUTE) && (_mAcc[0].count > 0) && ((_mAcc[0].time / period) != done)
+      && ((acc->count == 0) || ((acc->time / period) == (_mAcc[0].time / period))) )
+  {
+    metricClose(&_mAcc[0], &sample, _mSeries);
+    metricAdd(acc, sample, _mSeries, period);
+  }
+
+} // rebuildMetrics()
+
+
+//-------------------------------------------------------------------------------------
+//-- store numSeries values taken at timestamp (seconds, 0 -> time()), a minute (hour)
+//-- that is over is written to its tier
+boolean ESPSL::addSample(const float *values, uint32_t timestamp)
+{
+  ESPSL_Sample  sample;
+  File          mFile;
+  boolean       retVal;
+
+  if (_mSeries == 0) { return false; }
+  if (timestamp == 0) { timestamp = time(NULL); }
+  sample.time  = timestamp;
+  sample.count = 1;
+  for (uint8_t v = 0; v < _mSeries; v++)
+  {
+    sample.minV[v] = values[v];
+    sample.avgV[v] = values[v];
+    sample.maxV[v] = values[v];
+  }
+
+  _LOCKFILE();
+  mFile = SPIFFS.open(_metricsFile, "r+");
+  if (!mFile)
+  {
+    printf("ESPSL(%d)::addSample(): Some error opening [%s]\r\n", __LINE__, _metricsFile);
+    _UNLOCKFILE();
+    return false;
+  }
+  retVal = writeMetric(mFile, ESPSL_TIER_RAW, sample);
+  for (uint8_t tier = ESPSL_TIER_MINUTE; tier <= ESPSL_TIER_HOUR; tier++)
+  {
+    ESPSL_Sample *acc = &_mAcc[tier -1];
+    ESPSL_Sample  done;
+
+    if ((acc->count > 0) && ((timestamp / _PERIOD[tier]) != (acc->time / _PERIOD[tier])))
+    {
+      metricClose(acc, &done, _mSeries);
+      retVal &= writeMetric(mFile, tier, done);
+      acc->count = 0;
+    }
+    metricAdd(acc, sample, _mSeries, _PERIOD[tier]);
+  }
+  mFile.close();
+  _UNLOCKFILE();
+
+  return retVal;
+
+} // addSample()
+
+
+//-------------------------------------------------------------------------------------
+//-- hand the samples of tier with fromTime <= time <= toTime (oldest first) to callback(),
+//-- for the minute and hour tiers the period that is being collected comes last.
+//-- ESPSL_TIER_AUTO: the finest tier that still holds fromTime (or, if fromTime is older
+//-- than every sample, the oldest sample of all tiers)
+//-- stops early if callback() returns false
+int16_t ESPSL::readMetrics(uint8_t tier, uint32_t fromTime, uint32_t toTime, ESPSL_sampleCallback callback)
+{
+  ESPSL_Sample  sample;
+  File          mFile;
+  uint32_t      seq;
+  int16_t       samples = 0;
+
+#ifdef _DODEBUG
+  if (_Debug(3)) printf("ESPSL(%d)::readMetrics(%d, %u, %u)\r\n", __LINE__, tier, fromTime, toTime);
+#endif
+  if (_mSeries == 0) { return 0; }
+
+  _LOCKFILE();
+  mFile = SPIFFS.open(_metricsFile, "r");
+  if (!mFile)
+  {
+    _UNLOCKFILE();
+    return 0;
+  }
+  if (tier == ESPSL_TIER_AUTO)
+  {
+    uint32_t  oldest[ESPSL_TIER_HOUR +1];
+    uint32_t  oldestAny = 0xFFFFFFFF;   //-- oldest sample in any tier
+    uint8_t   t;
+
+    for (t = ESPSL_TIER_RAW; t <= ESPSL_TIER_HOUR; t++)
+    {
+      oldest[t] = 0xFFFFFFFF;   //-- no samples
+      seq = (_mSeq[t] >= _mSlots[t]) ? (_mSeq[t] - _mSlots[t] +1) : 1;
+      if ((_mSlots[t] > 0) && (_mSeq[t] > 0) && readMetric(mFile, t, seq, &sample)) { oldest[t] = sample.time; }
+      if (oldest[t] < oldestAny) { oldestAny = oldest[t]; }
+    }
+    //-- fromTime before all samples: the finest tier that goes back that far
+    uint32_t  startTime = (fromTime < oldestAny) ? oldestAny : fromTime;
+    for (tier = ESPSL_TIER_RAW; (tier <= ESPSL_TIER_HOUR) && (oldest[tier] > startTime); tier++) { }
+    if (tier > ESPSL_TIER_HOUR)
+    {
+      //-- no samples (yet): the finest tier there is
+      for (tier = ESPSL_TIER_RAW; (tier < ESPSL_TIER_HOUR) && (_mSlots[tier] == 0); tier++) { }
+    }
+  }
+  if (tier > ESPSL_TIER_HOUR)
+  {
+    mFile.close();
+    _UNLOCKFILE();
+    return 0;
+  }
 
-    if (lineID == (_lastUsedLineID)) 
+  seq = (_mSeq[tier] >= _mSlots[tier]) ? (_mSeq[tier] - _mSlots[tier] +1) : 1;
+  for (; seq <= _mSeq[tier]; seq++)
+  {
+    if (!readMetric(mFile, tier, seq, &sample))                   { continue; }
+    if ((sample.time < fromTime) || (sample.time > toTime))       { continue; }
+    samples++;
+    if (!callback(sample))
     {
-            printf("(a)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
-
-            println(">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>");
+      mFile.close();
+      _UNLOCKFILE();
+      return samples;
     }
-    else if (lineID == (_oldestLineID) ) //&& recKey < _numLines)
-            printf("(b)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
-    else if (lineID == _EMPTYID) 
-            printf("(c)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
-    else 
+  }
+  mFile.close();
+  if ((tier > ESPSL_TIER_RAW) && (_mAcc[tier -1].count > 0))
+  {
+    metricClose(&_mAcc[tier -1], &sample, _mSeries);
+    if ((sample.time >= fromTime) && (sample.time <= toTime))
     {
-       printf("(d)dumpLogFile(%d):: seek[%4d/%04d]ID[%8d]->[%s]\r\n", __LINE__, seekToLine, offset, lineID, globalBuff);
+      samples++;
+      callback(sample);
     }
-  } //-- while ..
+  }
+  _UNLOCKFILE();
 
-  return true;
+  return samples;
+
+} // readMetrics()
+
+
+//===========================================================================================
+//-- Archive: before the writer starts on a block of _ARCBLOCK slots, the lines in it are 
+//-- appended to the archive files (/sysLogArc<n>.dat, when one is full the oldest is 
+//-- started over). Every file is [_ARCMAGIC] followed by blocks:
+//--   [firstID, bytes, count] and count records [type, prefix, suffixLen, suffix]
+//-- The text of a record is front coded (prefix chars are the same as in the record before
+//-- it in the block), trailing spaces are left out. Type 0 -> the line was not in the log,
+//-- bit 7 -> the record is continued (_RECMORE).
+//===========================================================================================
+void ESPSL::setArchive(uint8_t numFiles, uint32_t maxFileSize)
+{
+  if (numFiles > _MAXARCFILES) { numFiles = _MAXARCFILES; }
+  _arcFiles   = numFiles;
+  _arcMaxSize = maxFileSize;
+  
+} // setArchive()
 
-} // dumpLogFile
 
 //-------------------------------------------------------------------------------------
-//-- erase SysLog file from SPIFFS
-boolean ESPSL::removeSysLog() 
+//-- find the file the blocks are appended to and the last lineID archived
+boolean ESPSL::loadArchive() 
 {
+  File      arcFile;
+  char      fileName[24];
+  uint8_t   header[7];
+  uint32_t  magic, pos;
+  uint16_t  bytes;
+  int32_t   firstID;
+
 #ifdef _DODEBUG
-  if (_Debug(1)) printf("ESPSL(%d)::removeSysLog()..\r\n", __LINE__);
+  if (_Debug(1)) printf("ESPSL(%d)::loadArchive()..\r\n", __LINE__);
 #endif
-  SPIFFS.remove(_sysLogFile);
+  _arcCurrent = 0;
+  _arcSize    = 0;
+  _arcLastID  = 0;
+  for (uint8_t a = 0; a < _arcFiles; a++)
+  {
+    _arcFirst[a] = 0;
+    snprintf(fileName, sizeof(fileName), _arcFile, a);
+    arcFile = SPIFFS.open(fileName, "r");
+    if (!arcFile) { continue; }
+    if (   (arcFile.read((uint8_t*)&magic, 4) == 4) && (magic == _ARCMAGIC)
+        && (arcFile.read(header, 7) == 7) )
+    {
+      memcpy(&_arcFirst[a], header, 4);
+    }
+    arcFile.close();
+    if (_arcFirst[a] > _arcFirst[_arcCurrent]) { _arcCurrent = a; }
+  }
+  if (_arcFirst[_arcCurrent] == 0) { return true; }   //-- nothing archived yet
+
+  //-- the last block of the newest file
+  snprintf(fileName, sizeof(fileName), _arcFile, _arcCurrent);
+  arcFile = SPIFFS.open(fileName, "r");
+  for (pos = 4; arcFile.seek(pos, SeekSet) && (arcFile.read(header, 7) == 7); pos += (7 + bytes))
+  {
+    memcpy(&firstID, header, 4);
+    memcpy(&bytes, (header +4), 2);
+    if ((pos + 7 + bytes) > arcFile.size()) { break; }
+    _arcLastID = firstID + header[6] -1;
+  }
+  _arcSize = pos;
+  //-- a block that was cut off (power loss): go on in the next file
+  if (_arcSize != arcFile.size()) { _arcSize = _arcMaxSize; }
+  arcFile.close();
+
+  if (_arcLastID > _lastUsedLineID)
+  {
+    printf("ESPSL(%d)::loadArchive(): archive does not match the logfile, removed\r\n", __LINE__);
+    removeArchive();
+  }
   return true;
-  
-} // removeSysLog()
+
+} // loadArchive()
+
 
 //-------------------------------------------------------------------------------------
-//-- returns ESPSL status info
-void ESPSL::status() 
+void ESPSL::removeArchive() 
 {
-  printf("ESPSL::status():       _numLines[%8d]\r\n", _numLines);
-  printf("ESPSL::status():      _lineWidth[%8d]\r\n", _lineWidth);
-  if (_numLines > 0) 
+  char  fileName[24];
+
+  if (_arcReadIdx >= 0) { _arcRead.close(); }
+  _arcReadIdx = -1;
+  for (uint8_t a = 0; a < _MAXARCFILES; a++)
   {
-    printf("ESPSL::status():   _oldestLineID[%8d] (%2d)\r\n", _oldestLineID
-                                                           , (_oldestLineID % _numLines)+1);
-    printf("ESPSL::status(): _lastUsedLineID[%8d] (%2d)\r\n", _lastUsedLineID
-                                                           , (_lastUsedLineID % _numLines)+1);
+    snprintf(fileName, sizeof(fileName), _arcFile, a);
+    SPIFFS.remove(fileName);
+    _arcFirst[a] = 0;
   }
-  printf("ESPSL::status():       _debugLvl[%8d]\r\n", _debugLvl);
-  
-} // status()
+  _arcCurrent = 0;
+  _arcSize    = 0;
+  _arcLastID  = 0;
 
-//-------------------------------------------------------------------------------------
-void ESPSL::setOutput(HardwareSerial *serIn, int baud)
-{
-  _Serial = serIn;
-  _Serial->begin(baud);
-  _Serial->printf("ESPSL(%d): Serial Output Ready..\r\n", __LINE__);
-  _serialOn = true;
-  
-} // setOutput(hw, baud)
+} // removeArchive()
 
-//-------------------------------------------------------------------------------------
-void ESPSL::setOutput(Stream *serIn)
-{
-  _Stream = serIn;
-  _Stream->printf("ESPSL(%d): Stream Output Ready..\r\n", __LINE__);
-  _streamOn = true;
-  
-} // setOutput(Stream)
 
 //-------------------------------------------------------------------------------------
-void ESPSL::print(const char *line)
+//-- append the lines fromID .. toID (and the rest of a line that is continued after
+//-- toID) as one block to the archive
+void ESPSL::archiveBlock(int32_t fromID, int32_t toID)
 {
-  if (_streamOn)  _Stream->print(line);
-  if (_serialOn)  _Serial->print(line);
-  
-} // print()
+  File        arcFile;
+  char        fileName[24];
+  char       *rec, *prev;     //-- live in front of the block, not on the stack of write()
+  uint8_t    *work, *block;
+  uint8_t     count   = 0;
+  uint16_t    bytes   = 7;
+  int         prevLen = 0;
+  int32_t     lineID, recID;
+  char        recType;
+  const char *text;
+  boolean     more = false;
+  uint32_t    magic = _ARCMAGIC;
+  int         maxCount;
+  int         room = ((_recLength +1) + _lineWidth);
+
+  if (fromID <= _arcLastID) { fromID = _arcLastID +1; }   //-- (lineID 0 does not exist)
+  if (fromID > toID)        { return; }
+  maxCount = (toID - fromID +1);
+  work     = (uint8_t*)malloc(room + 7 + (maxCount * (3 + _lineWidth)));
+  if (work == NULL)
+  {
+    printf("ESPSL(%d)::archiveBlock(): no memory, lines [%d .. %d] are not archived\r\n", __LINE__, fromID, toID);
+    return;
+  }
+  rec   = (char*)work;
+  prev  = (rec + (_recLength +1));
+  block = (work + room);
+
+  for (lineID = fromID; ((lineID <= toID) || more) && (lineID <= _lastUsedLineID) && (count < 255); lineID++)
+  {
+    uint8_t *out;
+    int      len    = 0;
+    int      prefix = 0;
+
+    if (count >= maxCount)
+    {
+      //-- a continued line runs past the block: make room for one more record
+      uint8_t *grown = (uint8_t*)realloc(work, room + 7 + ((maxCount +1) * (3 + _lineWidth)));
+      if (grown == NULL) { break; }
+      maxCount++;
+      work  = grown;
+      rec   = (char*)work;
+      prev  = (rec + (_recLength +1));
+      block = (work + room);
+    }
+    out    = (block + bytes);
+    more   = false;
+    out[0] = 0;           //-- not in the log
+    out[1] = 0;
+    out[2] = 0;
+    //-- the record may still be held in the batch
+    if (readSlot(((lineID % _numLines) +1), rec) == _recLength)
+    {
+      rec[_recLength] = '\0';
+      text = ESPSL_rec::parseKey(rec, &recID, &recType);
+      if ((text != NULL) && (recID == lineID))
+      {
+        more = (rec[_recLength -1] == _RECMORE);
+        rec[_recLength -1] = '\0';
+        len = strlen(text);
+        while ((len > 0) && (text[len -1] == ' '))                               { len--; }
+        while ((prefix < len) && (prefix < prevLen) && (text[prefix] == prev[prefix])) { prefix++; }
+        out[0] = ((uint8_t)recType | (more ? 0x80 : 0));
+        out[1] = prefix;
+        out[2] = (len - prefix);
+        memcpy((out +3), (text + prefix), (len - prefix));
+        memcpy(prev, text, len);
+        prevLen = len;
+      }
+    }
+    if ((lineID > toID) && (out[0] == 0)) { break; }
+    bytes += (3 + out[2]);
+    count++;
+  }
+  memcpy(block, &fromID, 4);
+  bytes -= 7;
+  memcpy((block +4), &bytes, 2);
+  block[6] = count;
+  bytes += 7;
+
+  //-- a full file: start the oldest file over
+  if ((_arcSize > 4) && ((_arcSize + bytes) > _arcMaxSize))
+  {
+    _arcCurrent = ((_arcCurrent +1) % _arcFiles);
+    _arcSize    = 0;
+  }
+  if (_arcReadIdx == _arcCurrent)
+  {
+    _arcRead.close();
+    _arcReadIdx = -1;
+  }
+  snprintf(fileName, sizeof(fileName), _arcFile, _arcCurrent);
+  arcFile = SPIFFS.open(fileName, ((_arcSize == 0) ? "w" : "a"));
+  if (!arcFile)
+  {
+    printf("ESPSL(%d)::archiveBlock(): Some error opening [%s]\r\n", __LINE__, fileName);
+    free(work);
+    return;
+  }
+  if (_arcSize == 0)
+  {
+    arcFile.write((const uint8_t*)&magic, 4);
+    _arcSize = 4;
+    _arcFirst[_arcCurrent] = fromID;
+  }
+  uint32_t started = micros();
+  if (arcFile.write(block, bytes) != bytes)
+  {
+    printf("ESPSL(%d)::archiveBlock(): Some error writing [%s]\r\n", __LINE__, fileName);
+  }
+  arcFile.close();
+  _statFlashUs += (micros() - started);
+  countFlashWrite(_arcSize, bytes);
+  _arcSize  += bytes;
+  _arcLastID = fromID + count -1;
+  free(work);
+
+} // archiveBlock()
+
 
 //-------------------------------------------------------------------------------------
-void ESPSL::println(const char *line)
+//-- oldest lineID in the archive (0 if it is empty)
+int32_t ESPSL::archiveOldestID()
 {
-  if (_streamOn)  _Stream->println(line);
-  if (_serialOn)  _Serial->println(line);
-  
-} // println()
+  int32_t oldestID = 0;
 
-//-------------------------------------------------------------------------------------
-void ESPSL::printf(const char *fmt, ...)
+  for (uint8_t a = 0; a < _arcFiles; a++)
+  {
+    if ((_arcFirst[a] > 0) && ((oldestID == 0) || (_arcFirst[a] < oldestID))) { oldestID = _arcFirst[a]; }
+  }
+  return oldestID;
+
+} // archiveOldestID()
+
+//-- is lineID read from the archive (it is no longer in the ring)?
+boolean ESPSL::inArchive(int32_t lineID)
 {
-  char lineBuff[(_MAXLINEWIDTH + 101)];
-  memset(lineBuff, 0, (_MAXLINEWIDTH + 101));
+  int32_t ringOldest = (_lastUsedLineID < _numLines) ? 1 : (_lastUsedLineID - _numLines +1);
 
-  va_list args;
-  va_start (args, fmt);
-  vsnprintf(lineBuff, (_MAXLINEWIDTH +100), fmt, args);
-  va_end (args);
+  if ((_arcFiles == 0) || (lineID > _arcLastID) || (lineID >= ringOldest)) { return false; }
+  return (lineID >= archiveOldestID());
 
-  if (_streamOn)  _Stream->print(lineBuff);
-  if (_serialOn)  _Serial->print(lineBuff);
+} // inArchive()
 
-} // printf()
 
 //-------------------------------------------------------------------------------------
-void ESPSL::flush()
+//-- move the read cursor to the block that holds lineID (reading on from the cursor 
+//-- if it is in the same file), false if lineID is not in the archive
+boolean ESPSL::seekArchive(int32_t lineID)
 {
-  if (_streamOn)  _Stream->flush();
-  if (_serialOn)  _Serial->flush();
-  
-} // flush()
-  
+  char      fileName[24];
+  uint8_t   header[7];
+  uint16_t  bytes;
+  uint32_t  pos;
+  int8_t    a = -1;
+
+  if ((_arcReadIdx >= 0) && (lineID >= _arcBlockFirst) && (lineID < (_arcBlockFirst + _arcBlockCount))) 
+  {
+    return true;
+  }
+  //-- the file with the newest first line <= lineID
+  for (uint8_t f = 0; f < _arcFiles; f++)
+  {
+    if ((_arcFirst[f] > 0) && (_arcFirst[f] <= lineID) && ((a < 0) || (_arcFirst[f] > _arcFirst[a]))) { a = f; }
+  }
+  if (a < 0) { return false; }
+
+  if ((a == _arcReadIdx) && (lineID >= _arcBlockFirst))
+  {
+    pos = _arcBlockPos;
+  }
+  else
+  {
+    if (_arcReadIdx >= 0) { _arcRead.close(); }
+    snprintf(fileName, sizeof(fileName), _arcFile, a);
+    _arcRead    = SPIFFS.open(fileName, "r");
+    _arcReadIdx = (_arcRead ? a : -1);
+    if (_arcReadIdx < 0) { return false; }
+    pos = 4;
+  }
+  _arcBlockCount = 0;
+  for (; _arcRead.seek(pos, SeekSet) && (_arcRead.read(header, 7) == 7); pos += (7 + bytes))
+  {
+    memcpy(&_arcBlockFirst, header, 4);
+    memcpy(&bytes, (header +4), 2);
+    _arcBlockPos = pos;
+    if (lineID < _arcBlockFirst) { break; }
+    if (lineID < (_arcBlockFirst + header[6]))
+    {
+      _arcBlockCount = header[6];
+      return true;
+    }
+  }
+  return false;
+
+} // seekArchive()
+
+
 //-------------------------------------------------------------------------------------
-//-- check fileSize of _sysLogFile
-boolean ESPSL::checkSysLogFileSize(const char* func, int32_t cSize)
+//-- read line lineID (with its continuation records) from the archive, returns the
+//-- same as readLine() and, like readRecord(), the text or the line as a JSON object
+int8_t ESPSL::readArchive(int32_t lineID, char *lineOut, int lineOutLen, boolean asJson)
 {
+  char      prev[_MAXLINEWIDTH];
+  uint8_t   rec[3];
+  int       prevLen = 0;
+  int       textLen = 0;
+  char      recType = 0;
+  int32_t   id;
+
 #ifdef _DODEBUG
-  if (_Debug(4)) printf("ESPSL(%d)::checkSysLogFileSize(%d)..\r\n", __LINE__, cSize);
+  if (_Debug(4)) printf("ESPSL(%d)::readArchive(%d)\r\n", __LINE__, lineID);
 #endif
-  int32_t fileSize = sysLogFileSize();
-  if (fileSize != cSize) 
+  lineOut[0] = '\0';
+  _LOCKFILE();
+  char     *buff = msgBuff();
+  if (!seekArchive(lineID) || !_arcRead.seek((_arcBlockPos + 7), SeekSet))
   {
-    printf("ESPSL(%d)::%s -> [%s] size is [%d] but should be [%d] .. error!\r\n"
-                                                          , __LINE__
-                                                          , func
-                                                          , _sysLogFile
-                                                          , fileSize, cSize);
-    return false;
+    _UNLOCKFILE();
+    return ESPSL_READ_OVERWRITTEN;
   }
-  return true;
-
-} // checkSysLogSize()
 
+  //-- the records are decoded from the start of the block (front coding)
+  for (id = _arcBlockFirst; id < (_arcBlockFirst + _arcBlockCount); id++)
+  {
+    if (_arcRead.read(rec, 3) != 3)   { break; }
+    if (rec[0] == 0)
+    {
+      if (id >= lineID) { break; }
+      continue;
+    }
+    if (   (rec[1] > prevLen) || ((rec[1] + rec[2]) >= _MAXLINEWIDTH)
+        || (_arcRead.read((uint8_t*)(prev + rec[1]), rec[2]) != rec[2]) ) { break; }
+    prevLen = (rec[1] + rec[2]);
+    if (id < lineID) { continue; }
+    if (id == lineID)                           { recType = (rec[0] & 0x7F); }
+    else if ((rec[0] & 0x7F) != _RECCONT)       { break; }
+    if ((textLen + (_lineWidth -1)) > msgLength()) { break; }
+    memcpy((buff + textLen), prev, prevLen);
+    textLen += prevLen;
+    if ((rec[0] & 0x80) == 0) { break; }
+    //-- continued: the chunk had all its (trailing) spaces
+    memset((buff + textLen), ' ', ((_lineWidth -1) - prevLen));
+    textLen += ((_lineWidth -1) - prevLen);
+  }
+  if (recType == 0)
+  {
+    _UNLOCKFILE();
+    return ESPSL_READ_OVERWRITTEN;
+  }
+  buff[textLen] = '\0';
+  rtrim(buff);
+  _readLevel = ESPSL_rec::levelOf(recType);
+  _readType  = recType;
+  if (recType == _RECCONT)
+  {
+    _UNLOCKFILE();
+    return ESPSL_READ_CONTINUED;
+  }
+  if (recType == _RECEVENT)
+  {
+    ESPSL_rec::renderEvent(buff, lineID, lineOut, lineOutLen, asJson);
+  }
+  else if (asJson)
+  {
+    ESPSL_rec::renderJsonText(buff, lineID, _readLevel, lineOut, lineOutLen);
+  }
+  else
+  {
+    strlcpy(lineOut, buff, lineOutLen);
+  }
+  _UNLOCKFILE();
 
-//-------------------------------------------------------------------------------------
-//-- returns lastUsed LineID
-uint32_t ESPSL::getLastLineID()
-{
-  return _lastUsedLineID;
-  
-} // getLastLineID()
+  return ESPSL_READ_OK;
 
-//-------------------------------------------------------------------------------------
-//-- set Debug Level
-void ESPSL::setDebugLvl(int8_t debugLvl)
-{
-  if (debugLvl >= 0 && debugLvl <= 9)
-        _debugLvl = debugLvl;
-  else  _debugLvl = 1;
-  
-} // setDebugLvl
+} // readArchive()
 
 //-------------------------------------------------------------------------------------
 //-- returns debugLvl
@@ -821,140 +3830,6 @@ const char* ESPSL::rtrim(char *aChr)
   return aChr;
 } // rtrim()
 
-//===========================================================================================
-void ESPSL::fixLineWidth(char *inLine, int lineLen) 
-{
-  int16_t newLen;
-  
-#ifdef _DODEBUG
-  if (_Debug(4)) printf("ESPSL(%d)::fixLineWidth([%s], %d) ..\r\n", __LINE__, inLine, lineLen);
-#endif
-  char fixLine[(lineLen+1)];
-  memset(fixLine, 0, (lineLen+1));
-
-  //printf("ESPSL(%d)::fixLineWidth(): inLine[%s]\r\n", __LINE__, inLine);
-
-  snprintf(fixLine, lineLen, "%s", inLine);
-  //printf("ESPSL(%d)::fixLineWidth(): fixLine[%s]\r\n", __LINE__, fixLine);
-
-#ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d):: [%s]\r\n", __LINE__, fixLine);
-#endif
-  //-- first: remove control chars
-  for(int i=0; i<strlen(fixLine); i++)
-  {
-    if ((fixLine[i] < ' ') || (fixLine[i] > '~')) { fixLine[i] = '^'; }
-  }
-  //-- add spaces at the end
-  do {
-      strlcat(fixLine, "     ", lineLen);
-      newLen = strlen(fixLine);
-  } while(newLen < (lineLen-1));
-  //printf("ESPSL(%d)::fixLineWidth(): fixLine[%s]\r\n", __LINE__, fixLine);
-  
-#ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d):: [%s]\r\n", __LINE__, fixLine);
-#endif
-
-  memset(inLine, 0, lineLen);
-  strlcpy(inLine, fixLine, lineLen);
-  //printf("ESPSL(%d):: in[%s] -> out[%s] (len[%d])\r\n", __LINE__, fixLine, inLine, lineLen);
-  
-#ifdef _DODEBUG
-  if (_Debug(4)) printf("ESPSL(%d)::fixLineWidth(): Length of inLine is [%d] bytes\r\n", __LINE__, strlen(inLine));
-#endif
-  //printf("ESPSL(%d)::fixLineWidth(): inLine[%s]\r\n", __LINE__, inLine);
-  
-} // fixLineWidth()
-
-//===========================================================================================
-void ESPSL::fixRecLen(char *recIn, int32_t recKey, int recLen) 
-{
-  int newLen;
-  
-#ifdef _DODEBUG
-  if (_Debug(4)) printf("ESPSL(%d)::fixRecLen([%s], %d, %d) ..\r\n", __LINE__, recIn, recKey, recLen);
-#endif
-  char recOut[(recLen+1)];
-  memset(recOut, 0, (recLen+1));
-
-  snprintf(recOut, recLen, "%010d|%s", recKey, recIn);
-#ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d):: [%s]\r\n", __LINE__, recOut);
-#endif
-  //-- add spaces at the end
-  do {
-      strlcat(recOut, "     ", recLen);
-      newLen = strlen(recOut);
-  } while(newLen < (recLen-1));
-  
-#ifdef _DODEBUG
-  if (_Debug(3)) printf("ESPSL(%d):: [%d]->[%-20.20s]\r\n", __LINE__, recKey, recOut);
-#endif
-
-  strlcpy(recIn, recOut, recLen);
-
-#ifdef _DODEBUG
-  if (_Debug(4)) printf("ESPSL(%d)::fixRecLen(): Length of record is [%d] bytes\r\n", __LINE__, strlen(recIn));
-#endif
-  
-  //printf("ESPSL(%d):: record(%010d)->[%s]\r\n", __LINE__, recKey, recIn);
-  
-} // fixRecLen()
-
-//===========================================================================================
-int32_t  ESPSL::sysLogFileSize()
-{
-#if defined(ESP8266)
-  {
-    Dir dir = SPIFFS.openDir("/");         // List files on SPIFFS
-    while (dir.next())  {
-          yield();
-          String fileName = dir.fileName();
-          size_t fileSize = dir.fileSize();
-#ifdef _DODEBUG
-          if (_Debug(6)) printf("ESPSL)%d)::sysLogFileSize(): found: %s, size: %d\r\n"
-                                                                             , __LINE__
-                                                                             , fileName.c_str()
-                                                                             , fileSize);
-#endif
-          if (fileName == _sysLogFile) {
-#ifdef _DODEBUG
-            if (_Debug(6)) printf("ESPSL(%d)::sysLogFileSize(): fileSize[%d]\r\n", __LINE__, fileSize);
-#endif
-            return (int32_t)fileSize;
-          }
-    }
-  return 0;
-  }
-#else
-  {
-      File root = SPIFFS.open("/");
-      File file = root.openNextFile();
-      while(file)
-      {
-          String tmpS = file.name();
-          String fileName = "/"+tmpS;
-          size_t fileSize = file.size();
-#ifdef _DODEBUG
-          if (_Debug(4)) printf("ESPSL(%d)::FS Found: %s, size: %d\n", __LINE__, fileName.c_str(), fileSize);
-#endif
-          if (fileName == _sysLogFile) 
-          {
-#ifdef _DODEBUG
-            if (_Debug(4)) printf("ESPSL(%d)::sysLogFileSize(): fileSize[%d]\r\n", __LINE__, fileSize);
-#endif
-            printf("ESPSL(%d)::sysLogFileSize(): file is still [%d]bytes\r\n", __LINE__, (int32_t)fileSize);
-            return (int32_t)fileSize;
-          }
-          file = root.openNextFile();
-      }
-      return 0;
-  }
-#endif
-
-} // sysLogFileSize()
-
 
 /***************************************************************************
 *
@@ -14,19 +14,109 @@
 #include <FS.h>
 #ifndef ESP8266
   #include <SPIFFS.h>
+  #include <WiFi.h>
+#else
+  #include <ESP8266WiFi.h>
 #endif 
+#include <WiFiUdp.h>
+#include "ESPSL_format.h"
+#include "ESPSL_record.h"
+#if defined(ESP32)
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/semphr.h>
+  #include <esp_system.h>
+  #include <esp_attr.h>
+  //-- readers and the writer can live in different tasks
+  #define _LOCKFILE()     xSemaphoreTakeRecursive(_fileLock, portMAX_DELAY)
+  #define _UNLOCKFILE()   xSemaphoreGiveRecursive(_fileLock)
+#else
+  #define _LOCKFILE()
+  #define _UNLOCKFILE()
+#endif
+
+//-- duplicate-message suppression modes (see setDuplicateFilter())
+#define ESPSL_DEDUP_OFF     0   //-- every line is written
+#define ESPSL_DEDUP_TEXT    1   //-- collapse consecutive identical lines
+#define ESPSL_DEDUP_FORMAT  2   //-- collapse consecutive lines with the same format string
+
+//-- return values of readLine()
+#define ESPSL_READ_OK           0
+#define ESPSL_READ_OVERWRITTEN  1   //-- line is no longer in the log
+#define ESPSL_READ_NOTWRITTEN   2   //-- line is not (yet) written
+#define ESPSL_READ_ERROR        3
+#define ESPSL_READ_CONTINUED    4   //-- lineID holds the rest of the line before it
+
+//-- called by readPage() for every line, return false to stop
+typedef bool (*ESPSL_lineCallback)(int32_t lineID, const char *lineText);
+
+//-- tiers of the metrics store (see setMetrics())
+#define ESPSL_TIER_RAW      0   //-- every sample
+#define ESPSL_TIER_MINUTE   1   //-- min/avg/max per minute
+#define ESPSL_TIER_HOUR     2   //-- min/avg/max per hour
+#define ESPSL_TIER_AUTO   255   //-- the finest tier that goes back far enough
+#define ESPSL_MAXSERIES     4   //-- values per sample
+
+//-- a sample (raw tier: count 1, min = avg = max) or a minute/hour of samples
+struct ESPSL_Sample {
+  uint32_t  time;       //-- raw: time of the sample, minute/hour: start of the period
+  uint16_t  count;      //-- samples in the period
+  float     minV[ESPSL_MAXSERIES];
+  float     avgV[ESPSL_MAXSERIES];
+  float     maxV[ESPSL_MAXSERIES];
+};
+
+//-- called by readMetrics() for every sample, return false to stop
+typedef bool (*ESPSL_sampleCallback)(const ESPSL_Sample &sample);
+
+class ESPSL_Event;
+class ESPSL_Reader;
 
 class ESPSL {
 
+  friend class ESPSL_Event;
+  friend class ESPSL_Reader;
+
   #define _DODEBUG
+  //#define _LOWMEMORY            //-- no RAM batching, small printf() buffer
   #define _MAXLINEWIDTH 150
   #define _MINLINEWIDTH  50
   #define _MINNUMLINES   10
-  #define _KEYLEN        11
-  #define _EMPTYID       -1
-  
+#ifdef _LOWMEMORY
+  #define _MAXMSGLEN    _MAXLINEWIDTH   //-- (almost) no continuation records
+#else
+  #define _MAXMSGLEN    600      //-- max. length of a line spread over continuation records
+#endif
+  #define _MSGBUFFLEN   (_MAXMSGLEN +15)              //-- _msgBuff: a line being written or read
+  #define _LINEBUFFLEN  ((_MAXMSGLEN *2) + _KEYLEN)   //-- _lineBuff: a line handed to the caller
+  #define _DEDUPTIMEOUT  60000   //-- commit repeat counter after 60 seconds
+  #define _MAXBATCH         16   //-- max. records held in RAM before they are flushed
+  #define _MAXHOLDMS     60000   //-- adaptive policy: max. time a record is held in RAM
+  #define _FLASHPAGESIZE   256   //-- defaults if the FS does not tell us
+  #define _FLASHBLOCKSIZE 4096
+  #define _FLASHENDURANCE 10000  //-- guaranteed erase cycles per flash sector
+  #define _WEARWINDOW    60000   //-- min. uptime (ms) before the wear rate is trusted
+  #define _FWDSAVEINTERVAL 60000 //-- save the last forwarded lineID at most once a minute
+  #define _FWDMAXDATAGRAM  1400  //-- keep datagrams below the ethernet MTU
+  #define _FWDFACILITY       16  //-- syslog facility local0
+  #define _FWDTIMEVALID 1546300800  //-- time() before 1-1-2019 is not set (NILVALUE timestamp)
+  #define _IDXBLOCK          16  //-- lines per Bloom filter of the search index
+  #define _IDXBYTES         128  //-- size of one Bloom filter (1024 bits)
+  #define _IDXHASHES          4  //-- bits set per word
+  #define _IDXMAGIC  0x494C5345  //-- "ESLI"
+  #define _MAXSESSIONS        8  //-- boot sessions kept in _bootFile
+  #define _MAXSLEEPBATCH     64  //-- max. records held in RAM by setSleepPolicy()
+  #define _RTCBATCHBYTES   4096  //-- ESP32: RTC memory that holds them
+  #define _RTCMAGIC  0x52534C45  //-- "ESLR"
+  #define _METRICSMAGIC 0x4D534C45  //-- "ESLM"
+  #define _ARCBLOCK          16  //-- slots archived at a time
+  #define _MAXARCFILES        8  //-- max. archive files (setArchive())
+  #define _ARCMAGIC  0x41534C45  //-- "ESLA"
+
 public:
   ESPSL();
+  ~ESPSL();
+  ESPSL(const ESPSL&) = delete;               //-- owns buffers and files
+  ESPSL &operator=(const ESPSL&) = delete;
 
   boolean   begin(uint16_t depth,  uint16_t lineWidth);
   boolean   begin(uint16_t depth,  uint16_t lineWidth, boolean mode);
@@ -35,44 +125,229 @@ public:
   boolean   writef(const char *fmt, ...);
   char     *buildD(const char *fmt, ...);
   boolean   writeDbg(const char *dbg, const char *fmt, ...);
+  boolean   writeLevel(uint8_t level, const char *logLine);
+  boolean   writefLevel(uint8_t level, const char *fmt, ...);
+  void      setRetention(uint16_t reservedLines);   // call before begin()
+  void      setContinuation(uint8_t maxRecords);
+  uint8_t   getLineLevel();   // level of the last line read
+  template<typename... A>
+  boolean   writeT(const char *dbg, const char *fmt, A... args);   // use SYSLOG_F() / SYSLOG_DBG()
   void      startReading();    // Returns last line read
   bool      readNextLine(char *lineOut, int lineOutLen);
   bool      readPreviousLine(char *lineOut, int lineOutLen);
+  int8_t    readLine(int32_t lineID, char *lineOut, int lineOutLen);
+  int16_t   readPage(int32_t startID, int16_t count, ESPSL_lineCallback callback);
   bool      dumpLogFile();
   boolean   removeSysLog();
   uint32_t  getLastLineID();
+  int32_t   getOldestLineID();
   void      setOutput(HardwareSerial *serIn, int baud);
   void      setOutput(Stream *serIn);
   void      setDebugLvl(int8_t debugLvl);
+  void      setDuplicateFilter(uint8_t mode, uint32_t commitAfterMs = _DEDUPTIMEOUT);
+  void      loop();
+  boolean   flushLog();
+  void      setFlushPolicy(uint16_t maxBatch, uint32_t maxDelayMs);
+  void      setWearBudget(float erasesPerDay);
+  float     getErasesPerDay();
+  float     getProjectedLifetime();   // in days
+  void      wearStatus();
+  void      setSleepPolicy(uint32_t flushAtBytes, uint32_t idleMs = 0);
+  boolean   prepareForSleep();
+  uint32_t  getFlashSessions();
+  uint32_t  getFlashActiveMs();
+  boolean   setSyslogServer(const char *server, uint16_t port = 514
+                          , const char *hostName = "esp", const char *appName = "ESPSL");
+  void      setForwardLimits(uint8_t linesPerDatagram, uint16_t datagramsPerSecond
+                           , boolean nonStandard = false);
+  int16_t   forward();
+  int32_t   getForwardedLineID();
+  int16_t   exportJson(Print *out, int32_t fromID = 0);
+  void      setSearchIndex(boolean enable);   // call before begin()
+  int16_t   search(const char *word, ESPSL_lineCallback callback, int32_t fromID = 0);
+  uint8_t   getSessionCount();
+  int32_t   getSessionStartID(uint8_t session);   // 0 = this boot, 1 = the boot before ..
+  int32_t   getSessionEndID(uint8_t session);
+  int16_t   readSession(uint8_t session, ESPSL_lineCallback callback);
+  void      setMetrics(uint8_t numSeries, uint16_t rawSamples
+                     , uint16_t minuteSamples = 0, uint16_t hourSamples = 0);   // call before begin()
+  boolean   addSample(const float *values, uint32_t timestamp = 0);
+  int16_t   readMetrics(uint8_t tier, uint32_t fromTime, uint32_t toTime, ESPSL_sampleCallback callback);
+  void      setArchive(uint8_t numFiles, uint32_t maxFileSize);   // call before begin()
     
 private:
 
   const char *_sysLogFile = "/sysLog.dat";
+  const char *_fwdFile    = "/sysLogFwd.dat";
+  const char *_idxFile    = "/sysLogIdx.dat";
+  const char *_bootFile   = "/sysLogBoot.dat";
+  const char *_metricsFile = "/sysLogMetrics.dat";
+  const char *_arcFile    = "/sysLogArc%d.dat";
   HardwareSerial  *_Serial;
   Stream          *_Stream;
   boolean         _streamOn;
   boolean         _serialOn;
 
   File        _sysLog;
+#if defined(ESP32)
+  SemaphoreHandle_t _fileLock;
+#endif
   char        globalBuff[_MAXLINEWIDTH +15];
   int32_t     _lastUsedLineID;
+  int32_t     _ringLastID;              //-- init(): newest lineID in the ring (reserved can be newer)
   int32_t     _oldestLineID;
   int32_t     _numLines;
-  int32_t     _lineWidth;
+  int32_t     _generation     = 0;      //-- changes with every create() (record 0)
+  int32_t     _lineWidth      = 0;
   int32_t     _recLength;
   int32_t     _readNext;
   int32_t     _readNextEnd;
   int32_t     _readPrevious;
   int32_t     _readPreviousEnd;
+  uint8_t     _readLevel      = ESPSL_LEVEL_INFO;
+  char        _readType       = _RECTEXT;   //-- separator of the last record read
+  uint8_t     _maxRecords     = 1;      //-- records a line may use (setContinuation())
+  char       *_msgBuff        = NULL;   //-- setContinuation(): replaces globalBuff for long
+  char       *_lineBuff       = NULL;   //--   lines, and the buffer of the read paths
+  boolean     _lineBuffTaken  = false;
   int8_t      _debugLvl = 0;
+
+  uint8_t     _dedupMode      = ESPSL_DEDUP_OFF;
+  uint32_t    _dedupTimeout   = _DEDUPTIMEOUT;
+  const char *_dedupFmt       = NULL;   //-- format string of the line being written
+  uint32_t    _dedupHash      = 0;
+  boolean     _dedupValid     = false;
+  uint32_t    _dedupCount     = 0;
+  uint32_t    _dedupSince     = 0;
+
+  char       *_batchBuff      = NULL;   //-- records waiting to be flushed
+  uint16_t    _batchSize      = 0;      //-- capacity of _batchBuff in records
+  uint16_t    _batchMax       = 1;      //-- 1 -> write every record immediately
+  uint16_t    _batchMin       = 1;
+  uint16_t    _batchCount     = 0;
+  uint32_t    _batchSince     = 0;
+  uint32_t    _flushDelay     = 0;
+  uint32_t    _flushDelayMin  = 0;
+  float       _wearBudget     = 0.0;    //-- erases/day, 0 -> no adaptive policy
+
+  uint32_t    _fsPageSize     = _FLASHPAGESIZE;
+  uint32_t    _fsBlockSize    = _FLASHBLOCKSIZE;
+  uint32_t    _fsBlocks       = 0;
+  uint32_t    _wearStart      = 0;
+  uint32_t    _statRecords    = 0;      //-- records written since begin()
+  uint32_t    _statBytes      = 0;      //-- bytes handed to the FS
+  uint32_t    _statPages      = 0;      //-- (estimated) flash pages programmed
+  uint32_t    _statFlushes    = 0;
+  uint32_t    _wearWinStart   = 0;      //-- window used by the adaptive policy
+  uint32_t    _wearWinPages   = 0;
+  uint64_t    _statFlashUs    = 0;      //-- time spent writing to flash
+  uint32_t    _startOpenUs    = 0;      //-- time begin() spent opening the logfile,
+  uint32_t    _startValidateUs = 0;     //--   checking record 0 and the file size
+  uint32_t    _startRecoverUs = 0;      //--   and rebuilding the state (or the file)
+
+  uint32_t    _sleepBytes     = 0;      //-- 0 -> no sleep policy
+  uint32_t    _idleMs         = 0;      //-- flush after idleMs without new records
+  uint32_t    _batchLast      = 0;      //-- millis() of the last record held
+
+  WiFiUDP    *_fwdUdp         = NULL;   //-- NULL -> no forwarding
+  char        _fwdServer[40];
+  char        _fwdHostName[32];
+  char        _fwdAppName[32];
+  IPAddress   _fwdIP;
+  boolean     _fwdResolved    = false;
+  uint16_t    _fwdPort        = 514;
+  uint8_t     _fwdLines       = 1;      //-- lines per datagram (> 1 is not RFC 5426)
+  uint16_t    _fwdInterval    = 100;    //-- min. ms between datagrams
+  int32_t     _fwdLastID      = 0;      //-- last lineID sent to the collector
+  int32_t     _fwdGeneration  = 0;      //--   of the logfile with this generation
+  int32_t     _fwdSavedID     = 0;      //-- last lineID saved in _fwdFile
+  uint32_t    _fwdLastSend    = 0;
+  uint32_t    _fwdLastSave    = 0;
+  uint32_t    _fwdLost        = 0;      //-- lines overwritten before they were sent
+
+  uint16_t    _retainLines    = 0;      //-- requested by setRetention()
+  uint16_t    _numReserved    = 0;      //-- reserved slots (after the ring) in the file
+  int32_t    *_resIDs         = NULL;   //-- lineID in every reserved slot
+  uint16_t    _resNext        = 0;      //-- next reserved slot to (over)write
+
+  uint16_t   *_contBefore     = NULL;   //-- per ring slot: continuation records written
+  uint16_t    _contWritten    = 0;      //--   before it, and in total (wraps, see contBefore())
+
+  boolean     _idxEnabled     = false;
+  uint8_t    *_idxBloom       = NULL;   //-- 3 filters: writer's block (new lines, as saved)
+  int32_t     _idxBlock       = -1;     //--            and the reserved region
+
+  uint32_t    _bootCount      = 0;      //-- boots since the logfile was created
+  int32_t     _sessionIDs[_MAXSESSIONS];  //-- first lineID of the last boots (ring)
+
+  uint8_t     _mSeries        = 0;      //-- values per sample, 0 -> no metrics
+  uint16_t    _mSlots[3]      = { 0, 0, 0 };  //-- records per tier (raw, minute, hour)
+  uint32_t    _mSeq[3]        = { 0, 0, 0 };  //-- last record written per tier
+  ESPSL_Sample _mAcc[2];                //-- the minute and the hour being collected
+
+  uint8_t     _arcFiles       = 0;      //-- 0 -> no archive
+  uint32_t    _arcMaxSize     = 0;      //-- max. bytes per archive file
+  int32_t     _arcFirst[_MAXARCFILES];  //-- first lineID in every file (0 -> empty)
+  uint8_t     _arcCurrent     = 0;      //-- file the blocks are appended to
+  uint32_t    _arcSize        = 0;      //--   and its size
+  int32_t     _arcLastID      = 0;      //-- last lineID archived
+  File        _arcRead;                 //-- read cursor: open file,
+  int8_t      _arcReadIdx     = -1;     //--   its number (-1 -> none)
+  uint32_t    _arcBlockPos    = 0;      //--   and the block it is at
+  int32_t     _arcBlockFirst  = 0;
+  uint8_t     _arcBlockCount  = 0;
   
   boolean     create(uint16_t depth, uint16_t lineWidth);
   boolean     init();
+  boolean     writeLine(const char*, char recType);
+  boolean     writeFormatted(const char *fmt, const char *logLine, char recType = _RECTEXT);
+  boolean     writeRecord(const char*, char recType = _RECTEXT, boolean more = false);
+  void        writeReserved(const char*, char recType);
+  uint32_t    slotOf(int32_t lineID);
+  int32_t     nextLineID(int32_t fromID, boolean withArchive = true);
+  int32_t     prevLineID(int32_t fromID);
+  boolean     contBefore(int32_t lineID, uint16_t *count);
+  boolean     readRecord(uint32_t seekToLine, int32_t *lineID, char *lineOut, int lineOutLen
+                       , boolean asJson = false);
+  int         readSlot(uint32_t seekToLine, char *recOut);
+  boolean     isDuplicate(const char*, char);
+  void        commitRepeats();
+  void        countFlashWrite(uint32_t offset, uint32_t bytes);
+  void        adaptFlushPolicy();
+  uint16_t    sleepBatchSize();
+  void        freeBatch();
+  void        keepBatch();
+  void        saveForwardState();
+  void        startSession();
+  boolean     loadIndex();
+  void        indexRecord(uint32_t slot, const char *text, char recType);
+  void        indexSlots(uint8_t *bloom, uint32_t fromSlot, uint32_t toSlot);
+  void        readIndexBlock(File &idxFile, int32_t block, uint8_t *bloom);
+  void        saveIndexBlock(int32_t block, const uint8_t *bloom);
+  boolean     mayContain(File &idxFile, int32_t block, uint32_t hash);
+  boolean     loadMetrics();
+  void        rebuildMetrics(File &mFile, uint8_t tier);
+  uint16_t    metricSize(uint8_t tier);
+  uint32_t    metricOffset(uint8_t tier, uint32_t seq);
+  boolean     readMetric(File &mFile, uint8_t tier, uint32_t seq, ESPSL_Sample *sample);
+  boolean     writeMetric(File &mFile, uint8_t tier, const ESPSL_Sample &sample);
+  boolean     loadArchive();
+  void        removeArchive();
+  void        archiveBlock(int32_t fromID, int32_t toID);
+  int32_t     archiveOldestID();
+  boolean     inArchive(int32_t lineID);
+  boolean     seekArchive(int32_t lineID);
+  int8_t      readArchive(int32_t lineID, char *lineOut, int lineOutLen, boolean asJson = false);
   const char *rtrim(char *);
   boolean     checkSysLogFileSize(const char* func, int32_t cSize);
-  int32_t     sysLogFileSize();
-  void        fixLineWidth(char *inLine, int lineLen);
-  void        fixRecLen(char *inLine, int32_t key, int recLen);
+  int32_t     printRecord(File &recFile, int32_t recKey, char recType, const char *text, boolean more = false);
+  uint16_t    msgLength();
+  char       *msgBuff();
+  int         msgBuffLen();
+  char       *takeLineBuff(char *localBuff, int *buffLen);
+  void        giveLineBuff(char *lineBuff, char *localBuff);
+  void        fixRecKey(char *keyOut, int32_t recKey, char recType);
+  void        fixRecText(char *textOut, const char *text);
   void        print(const char*);
   void        println(const char*);
   void        printf(const char *fmt, ...);
@@ -82,6 +357,165 @@ private:
 
 };
 
+//-------------------------------------------------------------------------------------
+//-- format with the (by SYSLOG_F() checked) fmt, every argument by its own type
+template<typename... A>
+boolean ESPSL::writeT(const char *dbg, const char *fmt, A... args) 
+{
+  int             dbgLen = 0;
+
+  _LOCKFILE();
+  char           *buff = msgBuff();
+  ESPSL_fmt::Out  out  = { buff, 0, (msgLength() +1) };
+  if (dbg != NULL) 
+  {
+    //-- dbg might be globalBuff itself (buildD())
+    while ((dbg[dbgLen] != '\0') && (dbgLen < msgLength())) { dbgLen++; }
+    memmove(buff, dbg, dbgLen);
+  }
+  buff[dbgLen] = '\0';
+  out.len = dbgLen;
+  ESPSL_fmt::format(out, fmt, args...);
+
+  boolean retVal = writeFormatted(fmt, buff);
+  _UNLOCKFILE();
+
+  return retVal;
+
+} // writeT()
+
+//-- structured log line: an event name with typed fields, stored in a compact
+//-- encoding and rendered as "event key=value .." (or JSON) when read
+class ESPSL_Event {
+
+public:
+  ESPSL_Event(ESPSL &sysLog, const char *eventName);
+
+  ESPSL_Event  &add(const char *key, int value);
+  ESPSL_Event  &add(const char *key, long value);
+  ESPSL_Event  &add(const char *key, unsigned int value);
+  ESPSL_Event  &add(const char *key, unsigned long value);
+  ESPSL_Event  &add(const char *key, float value);
+  ESPSL_Event  &add(const char *key, double value);
+  ESPSL_Event  &add(const char *key, bool value);
+  ESPSL_Event  &add(const char *key, const char *value);
+  boolean       write();
+
+private:
+  ESPSL      *_sysLog;
+  char        _rec[_MAXLINEWIDTH +1];
+  int16_t     _len;
+  int16_t     _maxLen;
+  int16_t     _fieldStart;
+
+  void        addName(char type, const char *name);
+  void        addChar(char c);
+  void        addNumber(uint32_t value, int8_t digits);
+  void        endField();
+
+};
+
+//-- independent read cursor, lines overwritten while reading are skipped
+class ESPSL_Reader {
+
+public:
+  ESPSL_Reader(ESPSL &sysLog);
+
+  void      startReading();
+  boolean   startReading(uint8_t session);
+  bool      readNextLine(char *lineOut, int lineOutLen);
+  bool      readPreviousLine(char *lineOut, int lineOutLen);
+  int32_t   getLineID();
+  uint32_t  getSkipped();
+
+private:
+  void      startCounting();
+  boolean   contBefore(int32_t lineID, uint16_t *count);
+
+  ESPSL      *_sysLog;
+  int32_t     _headID;      //-- last lineID when startReading() was called
+  int32_t     _nextID;
+  int32_t     _prevID;
+  int32_t     _lineID;
+  uint32_t    _skipped;     //-- lineIDs overwritten after startReading()
+  int32_t     _snapOldest;  //-- lines before this one were gone at startReading()
+  int32_t     _baseID;      //-- continuation records are left out from here on:
+  uint16_t    _contLow;     //--   written before _baseID,
+  uint16_t    _contHigh;    //--   before _headID +1 (valid if _highKnown),
+  boolean     _highKnown;
+  boolean     _nextKnown;   //--   before _nextID (_contLow +_nextRead +_nextCont),
+  uint16_t    _nextRead;    //--   read by readNextLine() and readPreviousLine()
+  uint16_t    _prevRead;
+  uint16_t    _nextCont;    //--   and skipped by them
+  uint16_t    _prevCont;
+
+};
+
+//===========================================================================================
+//-- ESPSL_Limiter: token bucket and 1-in-N sampling for one call site
+//-- (use SYSLOG_RATE() / SYSLOG_SAMPLE(), they keep a static limiter per call site)
+//===========================================================================================
+class ESPSL_Limiter {
+
+public:
+  ESPSL_Limiter(uint16_t perSecond, uint16_t burst, uint16_t sampleEvery);
+
+  inline bool   allow();
+  const char   *note();         // "(<n> suppressed) " or NULL
+  uint32_t      getSuppressed();
+
+private:
+  uint32_t    _rate;            //-- milli-tokens per ms (== tokens per second)
+  uint32_t    _capacity;        //-- in milli-tokens, 0 -> no rate limit
+  uint32_t    _tokens;
+  uint32_t    _lastRefill;
+  uint16_t    _sampleEvery;     //-- 1 -> every call
+  uint16_t    _calls;
+  uint32_t    _suppressed;      //-- calls dropped since the last line written
+  char        _note[26];        //-- "(4294967295 suppressed) "
+
+};
+
+//-------------------------------------------------------------------------------------
+//-- inline, a throttled call should cost no more than this
+inline bool ESPSL_Limiter::allow() 
+{
+  if (_sampleEvery > 1)
+  {
+    uint16_t call = _calls++;
+    if (_calls >= _sampleEvery)   { _calls = 0; }
+    if (call > 0)                 { _suppressed++; return false; }
+  }
+  if (_capacity > 0)
+  {
+    uint32_t now     = millis();
+    uint32_t elapsed = now - _lastRefill;
+    _lastRefill = now;
+    if (elapsed >= (_capacity / _rate))   { _tokens = _capacity; }
+    else if ((_tokens += (elapsed * _rate)) > _capacity) { _tokens = _capacity; }
+    if (_tokens < 1000)           { _suppressed++; return false; }
+    _tokens -= 1000;
+  }
+  return true;
+
+} // allow()
+
+//-- writef() for a call site that runs very often: at most perSecond lines per 
+//-- second (with bursts up to burst lines). Suppressed calls return before the
+//-- arguments are evaluated, the next line written tells how many were suppressed
+#define SYSLOG_RATE(sysLog, perSecond, burst, fmt, ...)                                     \
+    ({ static_assert(ESPSL_fmt::validate(fmt, decltype(ESPSL_fmt::typesOf(__VA_ARGS__))())   \
+                    , "SYSLOG_RATE(): format does not match the arguments");                \
+       static ESPSL_Limiter _espslLimiter((perSecond), (burst), 1);                         \
+       _espslLimiter.allow() && (sysLog).writeT(_espslLimiter.note(), fmt, ##__VA_ARGS__); })
+
+//-- writef() for one in every sampleEvery calls
+#define SYSLOG_SAMPLE(sysLog, sampleEvery, fmt, ...)                                        \
+    ({ static_assert(ESPSL_fmt::validate(fmt, decltype(ESPSL_fmt::typesOf(__VA_ARGS__))())   \
+                    , "SYSLOG_SAMPLE(): format does not match the arguments");              \
+       static ESPSL_Limiter _espslLimiter(0, 0, (sampleEvery));                             \
+       _espslLimiter.allow() && (sysLog).writeT(_espslLimiter.note(), fmt, ##__VA_ARGS__); })
+
 #endif
 
 /***************************************************************************